@@ -24,15 +24,28 @@
 
 #include "Read.hpp"
 #include "Graph.hpp"
+#include "CorrectionContext.hpp"
 
-AlignedRead::AlignedRead(Read &read, OutputMode output_mode)
+AlignedRead::AlignedRead(Read &read, OutputMode output_mode,
+        CorrectionContext &context)
       :        read_(read),
-        output_mode_(output_mode)
+        output_mode_(output_mode),
+        context_(context)
 {}
 
+//orders local alignments along the read
+static bool startsBefore(LocalAlignment const &a, LocalAlignment const &b) {
+        return a.get_read_start() < b.get_read_start();
+}
+
 std::vector<std::pair<int, int>> AlignedRead::not_corrected() {
-        sortAlongRead();
         std::vector<std::pair<int, int>> nc;
+        not_corrected(nc);
+        return nc;
+}
+
+void AlignedRead::not_corrected(std::vector<std::pair<int, int>> &nc) const {
+        nc.clear();
         int curr_pos = 0;
         int curr_al = 0;
         while (curr_pos < read_.size()) {
@@ -51,7 +64,6 @@ std::vector<std::pair<int, int>> AlignedRead::not_corrected() {
                 }
                 ++curr_al;
         }
-        return nc;
 }
 
 void AlignedRead::correct(std::vector<LocalAlignment> const &als) {
@@ -61,30 +73,27 @@ void AlignedRead::correct(std::vector<LocalAlignment> const &als) {
 }
 
 void AlignedRead::correct(LocalAlignment const &al) {
-        local_alignments_.push_back(al);
+        //insert after the alignments with the same start, keeping the
+        //alignments sorted along the read
+        local_alignments_.insert(std::upper_bound(local_alignments_.begin(),
+                local_alignments_.end(), al, startsBefore), al);
 }
 
 void AlignedRead::sortAlongRead() {
-        auto sort_alignments =
-                [&](LocalAlignment a, LocalAlignment b)-> bool
-        {
-                return a.get_read_start() < b.get_read_start();
-        };
-        std::sort(local_alignments_.begin(), local_alignments_.end(), sort_alignments);
+        std::stable_sort(local_alignments_.begin(), local_alignments_.end(),
+                startsBefore);
 }
 
 void AlignedRead::sortReadCov() {
         auto sort_alignments =
-                [&](LocalAlignment a, LocalAlignment b)-> bool
+                [&](LocalAlignment const &a, LocalAlignment const &b)-> bool
         {
                 return a.get_read_end() - a.get_read_start() < b.get_read_end() - b.get_read_start();
         };
         std::sort(local_alignments_.begin(), local_alignments_.end(), sort_alignments);
 }
 
-bool AlignedRead::fit(std::vector<int>::iterator const &index,
-        std::vector<int> const &lai, std::vector<int> const & laj)
-{
+bool AlignedRead::fit(int const *index, NodePath lai, NodePath laj) {
         if (index != laj.end()) {
                 int d = index - laj.begin() + 1;
                 d = d < lai.size() ? d : lai.size();
@@ -99,35 +108,96 @@ bool AlignedRead::fit(std::vector<int>::iterator const &index,
         }
 }
 
-bool AlignedRead::merge() {
-        sortAlongRead();
-        for (int i = 0; i < local_alignments_.size(); ++i) {
-                std::vector<int> lai = local_alignments_[i].get_path();
-                for (int j = 0; j < local_alignments_.size(); ++j) {
-                        if (i == j) {
-                                continue;
-                        }
-                        std::vector<int> laj = local_alignments_[j].get_path();
-                        std::vector<int>::iterator index;
-                        index = std::find(laj.begin(), laj.end(), lai.back());
-                        if (fit(index, lai, laj)) {
-                                lai.insert(lai.end(), index + 1, laj.end());
-                                local_alignments_[i].set_path(lai);
-                                int read_start = local_alignments_[i].get_read_start();
-                                int read_end = local_alignments_[j].get_read_end();
-                                int ref_start = local_alignments_[i].get_ref_start();
-                                int ref_size = read_end - read_start;
-                                if (ref_size < 0) {
+void AlignedRead::merge() {
+        int n = local_alignments_.size();
+        //index the alignments by the nodes on their paths, an alignment
+        //that extends another one starts with the end of its path
+        std::vector<std::pair<int, int>> &containing = context_.containing;
+        containing.clear();
+        for (int i = 0; i < n; ++i) {
+                for (int node : local_alignments_[i].get_path()) {
+                        containing.push_back(std::make_pair(node, i));
+                }
+        }
+        std::sort(containing.begin(), containing.end());
+        containing.erase(std::unique(containing.begin(), containing.end()),
+                containing.end());
+        //an absorbed alignment is represented by the alignment that absorbed
+        //it, whose path contains all of its nodes
+        std::vector<int> &owner = context_.owner;
+        owner.resize(n);
+        for (int i = 0; i < n; ++i) {
+                owner[i] = i;
+        }
+        //sweep along the read, every alignment absorbs the alignments that
+        //extend it until none is left
+        std::vector<bool> &merged = context_.merged;
+        merged.assign(n, false);
+        for (int i = 0; i < n; ++i) {
+                if (merged[i]) {
+                        continue;
+                }
+                while (true) {
+                        //extending the path may move it in the arena
+                        NodePath lai = local_alignments_[i].get_path();
+                        int next = -1;
+                        int const *index;
+                        auto candidates = std::equal_range(containing.begin(),
+                                containing.end(), std::make_pair(lai.back(), -1),
+                                [](std::pair<int, int> const &a,
+                                        std::pair<int, int> const &b)-> bool
+                        {
+                                return a.first < b.first;
+                        });
+                        for (auto c = candidates.first; c != candidates.second; ++c) {
+                                int j = c->second;
+                                while (owner[j] != j) {
+                                        j = owner[j];
+                                }
+                                if (j == i) {
+                                        continue;
+                                }
+                                NodePath laj = local_alignments_[j].get_path();
+                                index = std::find(laj.begin(), laj.end(), lai.back());
+                                //an extension may not end before the start
+                                if (fit(index, lai, laj)
+                                        && local_alignments_[j].get_read_end()
+                                        >= local_alignments_[i].get_read_start())
+                                {
+                                        next = j;
                                         break;
                                 }
-                                local_alignments_[i].set_read_end(read_end);
-                                local_alignments_[i].set_ref_end(ref_start + ref_size);
-                                local_alignments_.erase(local_alignments_.begin() + j);
-                                return true;
                         }
+                        if (next < 0) {
+                                break;
+                        }
+                        NodePath laj = local_alignments_[next].get_path();
+                        local_alignments_[i].extend_path(NodePath(index + 1,
+                                laj.end()));
+                        //the absorbed alignment may end before this one, a
+                        //copy truncated at the end of a window of a split read
+                        int read_start = local_alignments_[i].get_read_start();
+                        int read_end = std::max(local_alignments_[i].get_read_end(),
+                                local_alignments_[next].get_read_end());
+                        int ref_start = local_alignments_[i].get_ref_start();
+                        local_alignments_[i].set_read_end(read_end);
+                        local_alignments_[i].set_ref_end(ref_start + read_end - read_start);
+                        merged[next] = true;
+                        owner[next] = i;
+                }
+        }
+        //move the remaining alignments to the front, keeping their order
+        int kept = 0;
+        for (int i = 0; i < n; ++i) {
+                if (!merged[i]) {
+                        if (kept != i) {
+                                local_alignments_[kept] = std::move(local_alignments_[i]);
+                        }
+                        ++kept;
                 }
         }
-        return false;
+        local_alignments_.erase(local_alignments_.begin() + kept,
+                local_alignments_.end());
 }
 
 void AlignedRead::print() {
@@ -137,33 +207,33 @@ void AlignedRead::print() {
 }
 
 void AlignedRead::getCorrectedRead(Graph const &graph, std::vector<std::string> &corrections) {
-        while(merge());
+        merge();
         std::string corrected_read = "";
         if (local_alignments_.size() == 0) {
                 return;
         }
         int max_cov = 0;
         sortReadCov();
-        std::vector<LocalAlignment> corrs;
+        std::vector<LocalAlignment const *> corrs;
         for (const LocalAlignment &la : local_alignments_) {
                 bool overlaps = false;
-                for (const LocalAlignment &c : corrs) {
-                        if(la.overlapsOnRead(c)) {
+                for (const LocalAlignment *c : corrs) {
+                        if(la.overlapsOnRead(*c)) {
                                 overlaps = true;
                                 continue;
                         }
                 }
                 if(!overlaps) {
-                        corrs.push_back(la);
+                        corrs.push_back(&la);
                 }
         }
-        for (const LocalAlignment &la : corrs) {
-                std::string result = graph.concatenateNodes(la.get_path());
+        for (const LocalAlignment *la : corrs) {
+                std::string result = graph.concatenateNodes(la->get_path());
                 if (output_mode_ == LONG) {
-                        corrections.push_back(result);
+                        corrections.push_back(std::move(result));
                 } else if (output_mode_ == SHORT){
-                        result = result.substr(la.get_ref_start(), la.get_ref_end() - la.get_ref_start());
-                        corrections.push_back(result);
+                        corrections.push_back(result.substr(la->get_ref_start(),
+                                la->get_ref_end() - la->get_ref_start()));
                 }
         }
 }
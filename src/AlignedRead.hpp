@@ -28,28 +28,32 @@
 
 class Read;
 class Graph;
+struct CorrectionContext;
 
 
 struct AlignedRead {
 
         Read &read_; //reference to the read
-        std::vector<LocalAlignment> local_alignments_; //list of alignments
+        std::vector<LocalAlignment> local_alignments_; //list of alignments, sorted along the read
         OutputMode output_mode_;
+        CorrectionContext &context_; //buffers of the worker
 
 public:
         /*
          * ctors
          */
-        AlignedRead(Read &read, OutputMode output_mode);
+        AlignedRead(Read &read, OutputMode output_mode,
+                CorrectionContext &context);
         /*
          * methods
          */
         //getters
-        std::vector<LocalAlignment> get_local_alignments() {return local_alignments_;}
+        std::vector<LocalAlignment> const &get_local_alignments() const {return local_alignments_;}
         //setters
-        void set_local_alignments(std::vector<LocalAlignment> local_alignments) {local_alignments_ = local_alignments;}
+        void set_local_alignments(std::vector<LocalAlignment> local_alignments) {local_alignments_ = std::move(local_alignments); sortAlongRead();}
         //get a list of all regions that have not been corrected
         std::vector<std::pair<int, int>> not_corrected();
+        void not_corrected(std::vector<std::pair<int, int>> &nc) const;
         //add a list of local alignments
         void correct(std::vector<LocalAlignment> const &als);
         //add a local alignment
@@ -59,12 +63,13 @@ public:
                 std::vector<std::string> &corrections);
         //sort local_alignments_
         void sortAlongRead();
+        //sort by read coverage, only done once the read is corrected
         void sortReadCov();
         //checks if laj extends lai, overlap ends at index
-        bool fit(std::vector<int>::iterator const &index,
-                std::vector<int> const &lai, std::vector<int> const & laj);
-        //merge local alignments
-        bool merge();
+        bool fit(int const *index, NodePath lai, NodePath laj);
+        //merge the local alignments whose paths extend each other, in one
+        //sweep along the read
+        void merge();
         //print all local alignments
         void print();
 };
@@ -22,48 +22,218 @@
 #include "Alignment.hpp"
 #include <string>
 #include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits>
 #include <algorithm>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_X86_KERNELS
+#include <immintrin.h>
+#endif
+
 using namespace std;
 
+// ============================================================================
+// ANTI-DIAGONAL KERNELS
+// ============================================================================
+
+// score value of the cells outside the band
+static const int bandSentinel = numeric_limits<int>::min() / 2;
+
+struct BandScores {
+        int match;              // match score
+        int mismatch;           // mismatch penalty
+        int ins;                // insertion score
+        int del;                // deletion score
+};
+
+/**
+ * Fill n consecutive cells of an anti-diagonal. Cell x is the cell (i+x, j-x)
+ * @param cur Cells to fill
+ * @param up Cells (i+x-1, j-x)
+ * @param left Cells (i+x, j-x-1)
+ * @param diag Cells (i+x-1, j-x-1)
+ * @param a Characters s1[i+x-1]
+ * @param b Characters s2[j-x-1]
+ * @param n Number of cells
+ * @param sc Scoring scheme
+ * @return The number of cells that were filled
+ */
+typedef int (*DiagonalKernel)(int *cur, const int *up, const int *left,
+                              const int *diag, const char *a, const char *b,
+                              int n, const BandScores& sc);
+
+static int fillDiagonalScalar(int *cur, const int *up, const int *left,
+                              const int *diag, const char *a, const char *b,
+                              int n, const BandScores& sc)
+{
+        for (int x = 0; x < n; x++) {
+                bool hit = (a[x] == b[x]) || (a[x] == 'N') || (b[x] == 'N');
+                int score = diag[x] + ((hit) ? sc.match : sc.mismatch);
+                score = max(score, up[x] + sc.del);
+                score = max(score, left[x] + sc.ins);
+                cur[x] = score;
+        }
+
+        return n;
+}
+
+#ifdef HAVE_X86_KERNELS
+
+__attribute__((target("sse4.1")))
+static int fillDiagonalSSE41(int *cur, const int *up, const int *left,
+                             const int *diag, const char *a, const char *b,
+                             int n, const BandScores& sc)
+{
+        const __m128i vN = _mm_set1_epi32('N');
+        const __m128i vMatch = _mm_set1_epi32(sc.match);
+        const __m128i vMismatch = _mm_set1_epi32(sc.mismatch);
+        const __m128i vIns = _mm_set1_epi32(sc.ins);
+        const __m128i vDel = _mm_set1_epi32(sc.del);
+
+        int x = 0;
+        for ( ; x + 4 <= n; x += 4) {
+                int32_t ac, bc;
+                memcpy(&ac, a + x, sizeof(ac));
+                memcpy(&bc, b + x, sizeof(bc));
+                __m128i va = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(ac));
+                __m128i vb = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(bc));
+                __m128i hit = _mm_or_si128(_mm_cmpeq_epi32(va, vb),
+                              _mm_or_si128(_mm_cmpeq_epi32(va, vN),
+                                           _mm_cmpeq_epi32(vb, vN)));
+
+                __m128i score = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(diag + x)),
+                                              _mm_blendv_epi8(vMismatch, vMatch, hit));
+                score = _mm_max_epi32(score, _mm_add_epi32(_mm_loadu_si128((const __m128i*)(up + x)), vDel));
+                score = _mm_max_epi32(score, _mm_add_epi32(_mm_loadu_si128((const __m128i*)(left + x)), vIns));
+                _mm_storeu_si128((__m128i*)(cur + x), score);
+        }
+
+        return x;
+}
+
+__attribute__((target("avx2")))
+static int fillDiagonalAVX2(int *cur, const int *up, const int *left,
+                            const int *diag, const char *a, const char *b,
+                            int n, const BandScores& sc)
+{
+        const __m256i vN = _mm256_set1_epi32('N');
+        const __m256i vMatch = _mm256_set1_epi32(sc.match);
+        const __m256i vMismatch = _mm256_set1_epi32(sc.mismatch);
+        const __m256i vIns = _mm256_set1_epi32(sc.ins);
+        const __m256i vDel = _mm256_set1_epi32(sc.del);
+
+        int x = 0;
+        for ( ; x + 8 <= n; x += 8) {
+                __m256i va = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(a + x)));
+                __m256i vb = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(b + x)));
+                __m256i hit = _mm256_or_si256(_mm256_cmpeq_epi32(va, vb),
+                              _mm256_or_si256(_mm256_cmpeq_epi32(va, vN),
+                                              _mm256_cmpeq_epi32(vb, vN)));
+
+                __m256i score = _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(diag + x)),
+                                                 _mm256_blendv_epi8(vMismatch, vMatch, hit));
+                score = _mm256_max_epi32(score, _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(up + x)), vDel));
+                score = _mm256_max_epi32(score, _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(left + x)), vIns));
+                _mm256_storeu_si256((__m256i*)(cur + x), score);
+        }
+
+        return x;
+}
+
+#endif
+
+/**
+ * Select the widest kernel the CPU supports
+ * @return The anti-diagonal kernel
+ */
+static DiagonalKernel selectKernel()
+{
+#ifdef HAVE_X86_KERNELS
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+                return fillDiagonalAVX2;
+        if (__builtin_cpu_supports("sse4.1"))
+                return fillDiagonalSSE41;
+#endif
+        return fillDiagonalScalar;
+}
+
 // ============================================================================
 // ALIGNMENT CLASS
 // ============================================================================
 
 int Alignment::align(const string& s1, const string& s2)
 {
+        static const DiagonalKernel kernel = selectKernel();
+
+        const int len1 = s1.length();
+        const int len2 = s2.length();
+
         // reallocate memory if necessary
-        int thisMaxDim = max(s1.length(), s2.length());
+        int thisMaxDim = max(len1, len2);
         if (thisMaxDim > maxDim) {
                 maxDim = thisMaxDim;
                 delete [] M;
-                M = new int[(2*maxIndel+1) * (maxDim+1)];
+                M = new int[(2*maxDim+1) * diagonalSize()];
         }
 
-        // initialize the borders of the matrix
-        for (int i = 0; i <= maxIndel; i++)
-                (*this)(i, 0) = i * del;
+        // the kernels read up to 8 characters past the last cell; s2 is
+        // reversed so that both sequences are read forward along a diagonal
+        seq1.assign(s1);
+        seq1.append(8, '\0');
+        seq2.assign(s2.rbegin(), s2.rend());
+        seq2.append(8, '\0');
+
+        const BandScores sc = { match, mismatch, ins, del };
+        const int S = diagonalSize();
 
-        for (int i = 0; i <= maxIndel; i++)
-                (*this)(0, i) = i * ins;
+        for (int t = 0; t <= len1 + len2; t++) {
+                int *cur = M + t * S;
+                fill(cur, cur + S, bandSentinel);
 
-        // initialize the rest of the bulk of the matrix
-        for (int i = 1; i <= (int)s1.length(); i++) {
-                for (int j = max(1, i - maxIndel); j <= min((int)s2.length(), i + maxIndel); j++) {
+                // initialize the borders of the matrix
+                if (t <= maxIndel) {
+                        cur[(t + maxIndel + 2) >> 1] = t * del;         // (t, 0)
+                        cur[(maxIndel + 2 - t) >> 1] = t * ins;         // (0, t)
+                }
 
-                        bool hit = (s1[i-1] == s2[j-1]);
-                        if ((s1[i-1] == 'N') || (s2[j-1] == 'N'))
-                                hit = true;
+                if (t < 2)
+                        continue;
 
-                        int thisMatch = (*this)(i-1, j-1) + ((hit) ? match : mismatch);
-                        int thisDel = (j < i + maxIndel) ? (*this)(i-1, j) + del : thisMatch-1;
-                        int thisIns = (j > i - maxIndel) ? (*this)(i, j-1) + ins : thisMatch-1;
+                // band cells with 1 <= i <= len1 and 1 <= j <= len2, where
+                // d = i - j has the same parity as the diagonal t = i + j
+                int dFirst = max(max(-maxIndel, 2 - t), t - 2 * len2);
+                int dLast = min(min(maxIndel, t - 2), 2 * len1 - t);
+                dFirst += (t + dFirst) & 1;
+                dLast -= (t + dLast) & 1;
+                if (dFirst > dLast)
+                        continue;
 
-                        int score = max(thisMatch, max(thisDel, thisIns));
-                        (*this)(i, j) = score;
-                }
+                int first = (dFirst + maxIndel + 2) >> 1;
+                int n = (dLast - dFirst) / 2 + 1;
+                int i = (t + dFirst) / 2;
+                int j = t - i;
+
+                // cells (i-1, j) and (i, j-1) sit one slot apart on the
+                // previous diagonal, shifted depending on its parity
+                int *up = M + (t - 1) * S + first + ((t + maxIndel) & 1) - 1;
+                int *left = up + 1;
+                int *diag = M + (t - 2) * S + first;
+                const char *a = seq1.data() + i - 1;
+                const char *b = seq2.data() + len2 - j;
+
+                int x = kernel(cur + first, up, left, diag, a, b, n, sc);
+                fillDiagonalScalar(cur + first + x, up + x, left + x, diag + x,
+                                   a + x, b + x, n - x, sc);
         }
 
-        return (*this)(s1.length(), s2.length());
+        // the end cell cannot be reached within the band
+        if (abs(len1 - len2) > maxIndel)
+                return bandSentinel;
+
+        return (*this)(len1, len2);
 }
 
 Alignment::Alignment(int maxDim_, int maxIndel_, int match_,
@@ -71,14 +241,14 @@ Alignment::Alignment(int maxDim_, int maxIndel_, int match_,
                            maxIndel(maxIndel_), match(match_),
                            mismatch(mismatch_), ins(ins_), del(del_)
 {
-        M = new int[(2*maxIndel+1) * (maxDim+1)];
+        M = new int[(2*maxDim+1) * diagonalSize()];
 }
 
 void Alignment::printMatrix() const
 {
-        for (int l = 0; l < 2*maxIndel+1; l++) {
-                for (int k = 0; k < maxDim+1; k++)
-                        cout << M[k * (2 * maxIndel + 1) + l] << "\t";
+        for (int l = 0; l < diagonalSize(); l++) {
+                for (int t = 0; t < 2*maxDim+1; t++)
+                        cout << M[t * diagonalSize() + l] << "\t";
                 cout << endl;
         }
 }
@@ -22,6 +22,7 @@
 #define ALIGNMENT_HPP
 
 #include <iostream>
+#include <string>
 using namespace std;
 
 // ============================================================================
@@ -38,7 +39,29 @@ private:
         //int gap;                // gap score
         int ins;                // deletion score
         int del;                // insertion score
-        int *M;                 // alignment matrix
+        int *M;                 // banded alignment matrix, one anti-diagonal after the other
+        string seq1;            // padded copy of the first sequence
+        string seq2;            // padded, reversed copy of the second sequence
+
+        /**
+         * Get the number of cells stored per anti-diagonal: the 2*maxIndel+1
+         * band cells alternate between maxIndel and maxIndel+1 per diagonal,
+         * plus a sentinel on either side
+         * @return Number of cells per anti-diagonal
+         */
+        int diagonalSize() const {
+                return maxIndel + 3;
+        }
+
+        /**
+         * Get the position of cell (i, j) in the matrix M
+         * @param i Row index
+         * @param j Column index
+         * @return The position of cell (i, j) in M
+         */
+        int index(int i, int j) const {
+                return (i + j) * diagonalSize() + ((i - j + maxIndel + 2) >> 1);
+        }
 
         // void traceback(string& s1,string& s2,char **traceback );
         // void init();
@@ -64,19 +87,17 @@ public:
         }
 
         int operator() (int i, int j) const {
-                int k = max(i, j);
-                int l = maxIndel - i + j;
-                return M[k * (2 * maxIndel + 1) + l];
+                return M[index(i, j)];
         }
 
         int& operator() (int i, int j) {
-                int k = max(i, j);
-                int l = maxIndel - i + j;
-                return M[k * (2 * maxIndel + 1) + l];
+                return M[index(i, j)];
         }
 
         /**
-         * Perform the alignment between two sequences
+         * Perform the alignment between two sequences. The band is filled
+         * one anti-diagonal at a time so that all cells of a diagonal can be
+         * computed independently, using SSE4.1 or AVX2 when the CPU has it.
          * @param s1 First string
          * @param s2 Second string
          * @return The alignment score (higher is better)
@@ -0,0 +1,95 @@
+/*******************************************************************************
+ *   Copyright (C) 2014, 2015 Giles Miclotte (giles.miclotte@intec.ugent.be)   *
+ *   This file is part of Jabba                                                *
+ *                                                                             *
+ *   This program is free software; you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published by      *
+ *   the Free Software Foundation; either version 2 of the License, or         *
+ *   (at your option) any later version.                                       *
+ *                                                                             *
+ *   This program is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *   GNU General Public License for more details.                              *
+ *                                                                             *
+ *   You should have received a copy of the GNU General Public License         *
+ *   along with this program; if not, write to the                             *
+ *   Free Software Foundation, Inc.,                                           *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.                 *
+ *******************************************************************************/
+#ifndef CORRECTIONCONTEXT_HPP
+#define CORRECTIONCONTEXT_HPP
+
+#include <vector>
+#include <utility>
+
+#include "Alignment.hpp"
+#include "SeedTable.hpp"
+#include "InexactSeed.hpp"
+#include "LocalAlignment.hpp"
+#include "PathArena.hpp"
+
+//the extension of a node along unique paths in both directions
+struct PathExtension {
+        std::vector<int> pre_path; //path ending in the node
+        int pre_size; //length of the sequence of pre_path
+        std::vector<int> post_path; //path starting in the node
+        int post_size; //length of the sequence of post_path
+};
+
+//chained seeds of an uncorrected segment of the read
+struct SegmentChains {
+        std::pair<int, int> segment; //bounds of the segment in the read
+        std::vector<InexactSeed> chains; //inexact seeds of the segment
+};
+
+//buffers of a worker thread, reused for all the reads it corrects; the
+//state of a read is reset without releasing the storage, so correcting a
+//read hardly allocates once the buffers have grown
+struct CorrectionContext {
+        Alignment alignment; //banded alignment matrix
+        SeedTable seeds; //seeds of a read or window seeded on its own
+        //InterNodeChain
+        std::vector<std::pair<int, int>> segments; //uncorrected segments
+        std::vector<SegmentChains> segment_chains; //chains of the last pass
+        int num_segment_chains; //segments in use in segment_chains
+        std::vector<SegmentChains> next_segment_chains; //chains of this pass
+        std::vector<PathExtension> extensions; //path extensions of the read
+        int num_extensions; //extensions in use
+        std::vector<std::pair<int, int>> extension_index; //node and extension,
+                                                          //sorted on node
+        std::vector<int> segment_seeds; //seeds within a segment
+        std::vector<int> seeds_of_size; //number of seeds per length
+        std::vector<int> probable_nodes; //nodes that are chained
+        std::vector<Seed> node_seeds; //seeds of the node that is chained
+        std::vector<InexactSeed> inexact_seeds; //filtered seeds of a segment
+        std::vector<int> removed_seeds; //seeds removed by the global filter
+        std::vector<LocalAlignment> alignments; //alignments of a segment
+        PathArena paths; //paths of the alignments of the read
+        std::vector<int> anchor_path; //nodes the last seed of a chain runs through
+        //IntraNodeChain
+        std::vector<int> coverage; //best chain coverage ending in a seed
+        std::vector<int> predecessor; //previous seed in that chain
+        std::vector<int> order; //seeds on decreasing coverage
+        std::vector<bool> used; //seeds taken by a chain
+        std::vector<InexactSeed> chains; //chains of the node
+        //AlignedRead
+        std::vector<std::pair<int, int>> containing; //node and alignment
+        std::vector<int> owner; //alignment that absorbed an alignment
+        std::vector<bool> merged; //alignment was absorbed
+
+        CorrectionContext()
+              :        alignment(250, 30, 1, -4, -2, -3),
+                num_segment_chains(0),
+                num_extensions(0)
+        {}
+        //forget the state of the previous read
+        void clear() {
+                num_segment_chains = 0;
+                num_extensions = 0;
+                extension_index.clear();
+                paths.clear();
+        }
+};
+
+#endif
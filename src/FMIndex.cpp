@@ -0,0 +1,273 @@
+/*******************************************************************************
+ *   Copyright (C) 2014, 2015 Giles Miclotte (giles.miclotte@intec.ugent.be)   *
+ *   This file is part of Jabba                                                *
+ *                                                                             *
+ *   This program is free software; you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published by      *
+ *   the Free Software Foundation; either version 2 of the License, or         *
+ *   (at your option) any later version.                                       *
+ *                                                                             *
+ *   This program is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *   GNU General Public License for more details.                              *
+ *                                                                             *
+ *   You should have received a copy of the GNU General Public License         *
+ *   along with this program; if not, write to the                             *
+ *   Free Software Foundation, Inc.,                                           *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.                 *
+ *******************************************************************************/
+#include "FMIndex.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <climits>
+
+extern "C" { void suffixsort(int *x, int *p, int n, int k, int l); }
+
+//2-bit code of a nucleotide, -1 for anything else
+static inline int nucleotideCode(char c) {
+        switch (c) {
+                case 'A': return 0;
+                case 'C': return 1;
+                case 'G': return 2;
+                case 'T': return 3;
+                default: return -1;
+        }
+}
+
+//the lowest bits bits set
+static inline uint64_t lowMask(int bits) {
+        return bits >= 64 ? ~0ULL : (1ULL << bits) - 1;
+}
+
+//the low bit of every 2-bit character of word that equals c
+static inline uint64_t charMask(uint64_t word, int c) {
+        uint64_t x = word ^ (0x5555555555555555ULL * c);
+        return ~(x | (x >> 1)) & 0x5555555555555555ULL;
+}
+
+FMIndex::FMIndex(std::string const &reference, int sample_rate, long max_occ)
+      :        reference_(reference), sample_rate_(sample_rate),
+        max_occ_(max_occ), rows_(0)
+{
+        for (int c = 0; c < 4; ++c) {
+                C_[c] = 0;
+        }
+}
+
+void FMIndex::construct() {
+        long n = reference_.size();
+        if (n >= INT_MAX) {
+                std::cerr << "The FM index supports references up to "
+                        << INT_MAX - 1 << " characters." << std::endl;
+                exit(EXIT_FAILURE);
+        }
+        //suffix sort the text over $ < # < A < C < G < T, the terminator $
+        //is implicit and anything but a nucleotide separates like #
+        std::vector<int> x(n + 1), p(n + 1);
+        for (long i = 0; i < n; ++i) {
+                x[i] = nucleotideCode(reference_[i]) + 2;
+        }
+        suffixsort(&x[0], &p[0], n, 6, 1);
+        std::vector<int>().swap(x);
+        //row i of the BWT holds the character preceding suffix p[i]
+        rows_ = n + 1;
+        blocks_.assign(rows_ / 64 + 1, FMBlock());
+        samples_.clear();
+        long counts[4] = {0, 0, 0, 0};
+        long separators = 0;
+        for (long i = 0; i <= rows_; ++i) {
+                FMBlock &block = blocks_[i >> 6];
+                int r = i & 63;
+                if (r == 0) {
+                        for (int c = 0; c < 4; ++c) {
+                                block.counts[c] = counts[c];
+                        }
+                        block.samples = samples_.size();
+                        block.padding = 0;
+                        block.bwt[0] = block.bwt[1] = 0;
+                        block.special = block.sampled = 0;
+                }
+                if (i == rows_) {
+                        break;
+                }
+                long pos = p[i];
+                int c = pos == 0 ? -1 : nucleotideCode(reference_[pos - 1]);
+                if (c < 0) {
+                        block.special |= 1ULL << r;
+                        separators += pos != 0;
+                } else {
+                        block.bwt[r >> 5] |= (uint64_t)c << (2 * (r & 31));
+                        counts[c]++;
+                }
+                //rows preceded by a separator are sampled as well, so that
+                //locate never steps over one
+                if (c < 0 || pos % sample_rate_ == 0) {
+                        block.sampled |= 1ULL << r;
+                        samples_.push_back(pos);
+                }
+        }
+        C_[0] = 1 + separators;
+        for (int c = 1; c < 4; ++c) {
+                C_[c] = C_[c - 1] + counts[c - 1];
+        }
+}
+
+void FMIndex::save(std::string const &prefix) const {
+        std::string name = prefix + ".fmi";
+        std::ofstream fmi_s(name.c_str(), std::ios::binary);
+        long num_blocks = blocks_.size();
+        long num_samples = samples_.size();
+        fmi_s.write((const char*)&rows_, sizeof(rows_));
+        fmi_s.write((const char*)&sample_rate_, sizeof(sample_rate_));
+        fmi_s.write((const char*)C_, sizeof(C_));
+        fmi_s.write((const char*)&num_blocks, sizeof(num_blocks));
+        fmi_s.write((const char*)&blocks_[0], num_blocks * sizeof(FMBlock));
+        fmi_s.write((const char*)&num_samples, sizeof(num_samples));
+        fmi_s.write((const char*)&samples_[0], num_samples * sizeof(uint32_t));
+        fmi_s.close();
+}
+
+bool FMIndex::load(std::string const &prefix) {
+        std::string name = prefix + ".fmi";
+        std::ifstream fmi_s(name.c_str(), std::ios::binary);
+        if (!fmi_s.good()) {
+                return false;
+        }
+        long rows, num_blocks, num_samples;
+        int sample_rate;
+        fmi_s.read((char*)&rows, sizeof(rows));
+        fmi_s.read((char*)&sample_rate, sizeof(sample_rate));
+        //an index of another reference or sampling is rebuilt
+        if (!fmi_s.good() || rows != (long)reference_.size() + 1
+                || sample_rate != sample_rate_) {
+                return false;
+        }
+        rows_ = rows;
+        fmi_s.read((char*)C_, sizeof(C_));
+        fmi_s.read((char*)&num_blocks, sizeof(num_blocks));
+        blocks_.resize(num_blocks);
+        fmi_s.read((char*)&blocks_[0], num_blocks * sizeof(FMBlock));
+        fmi_s.read((char*)&num_samples, sizeof(num_samples));
+        samples_.resize(num_samples);
+        fmi_s.read((char*)&samples_[0], num_samples * sizeof(uint32_t));
+        return fmi_s.good();
+}
+
+inline long FMIndex::rank(int c, long i) const {
+        FMBlock const &block = blocks_[i >> 6];
+        int r = i & 63;
+        long count = block.counts[c];
+        if (r > 32) {
+                count += __builtin_popcountll(charMask(block.bwt[0], c));
+                count += __builtin_popcountll(charMask(block.bwt[1], c)
+                        & lowMask(2 * (r - 32)));
+        } else {
+                count += __builtin_popcountll(charMask(block.bwt[0], c)
+                        & lowMask(2 * r));
+        }
+        if (c == 0) {
+                //the separators are stored as A
+                count -= __builtin_popcountll(block.special & lowMask(r));
+        }
+        return count;
+}
+
+inline int FMIndex::get_char(long row) const {
+        FMBlock const &block = blocks_[row >> 6];
+        int r = row & 63;
+        if ((block.special >> r) & 1) {
+                return -1;
+        }
+        return (block.bwt[r >> 5] >> (2 * (r & 31))) & 3;
+}
+
+inline FMIndex::Interval FMIndex::extend(int c,
+        Interval const &interval) const
+{
+        Interval result;
+        if (c < 0 || interval.size() <= 0) {
+                result.start = result.end = 0;
+        } else {
+                result.start = C_[c] + rank(c, interval.start);
+                result.end = C_[c] + rank(c, interval.end);
+        }
+        return result;
+}
+
+long FMIndex::locate(long row) const {
+        long steps = 0;
+        while (!((blocks_[row >> 6].sampled >> (row & 63)) & 1)) {
+                //unsampled rows hold a nucleotide
+                int c = get_char(row);
+                row = C_[c] + rank(c, row);
+                steps++;
+        }
+        FMBlock const &block = blocks_[row >> 6];
+        long sample = block.samples
+                + __builtin_popcountll(block.sampled & lowMask(row & 63));
+        return samples_[sample] + steps;
+}
+
+void FMIndex::findMatches(std::string const &read,
+        std::vector<bool> const *skip, mem_visitor_t &visitor,
+        int const min_len) const
+{
+        long n = read.size();
+        long ref_size = reference_.size();
+        Interval all;
+        all.start = 0;
+        all.end = rows_;
+        std::vector<long> left_maximal;
+        //for every end e, search read[q, e) backwards while keeping the rows
+        //of read[q, e] as well: once both are equally large every occurrence
+        //is followed by read[e] and none of them can be right maximal
+        for (long e = n; e >= min_len; --e) {
+                int next = e < n ? nucleotideCode(read[e]) : -1;
+                Interval current = all;
+                Interval longer = extend(next, all);
+                long q = e;
+                while (current.size() != longer.size()) {
+                        int c = q > 0 ? nucleotideCode(read[q - 1]) : -1;
+                        Interval extended = extend(c, current);
+                        long len = e - q;
+                        bool skipped = skip != NULL && (*skip)[q];
+                        if (len >= min_len && !skipped
+                                && extended.size() < current.size())
+                        {
+                                //rows not preceded by c are left maximal
+                                left_maximal.clear();
+                                for (long row = current.start; row < current.end; ++row) {
+                                        if (c < 0 || get_char(row) != c) {
+                                                left_maximal.push_back(row);
+                                        }
+                                }
+                                long stride = 1;
+                                if (max_occ_ > 0 && (long)left_maximal.size() > max_occ_) {
+                                        stride = (left_maximal.size() + max_occ_ - 1) / max_occ_;
+                                }
+                                for (size_t i = 0; i < left_maximal.size(); i += stride) {
+                                        long pos = locate(left_maximal[i]);
+                                        if (next >= 0 && pos + len < ref_size
+                                                && reference_[pos + len] == read[e]) {
+                                                continue;
+                                        }
+                                        visitor.visit(match_t(pos, q, len, current.size()));
+                                }
+                        }
+                        if (extended.size() == 0) {
+                                break;
+                        }
+                        longer = extend(c, longer);
+                        current = extended;
+                        q--;
+                }
+        }
+}
+
+long FMIndex::size_in_bytes() const {
+        return blocks_.size() * sizeof(FMBlock)
+                + samples_.size() * sizeof(uint32_t);
+}
@@ -0,0 +1,94 @@
+/*******************************************************************************
+ *   Copyright (C) 2014, 2015 Giles Miclotte (giles.miclotte@intec.ugent.be)   *
+ *   This file is part of Jabba                                                *
+ *                                                                             *
+ *   This program is free software; you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published by      *
+ *   the Free Software Foundation; either version 2 of the License, or         *
+ *   (at your option) any later version.                                       *
+ *                                                                             *
+ *   This program is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *   GNU General Public License for more details.                              *
+ *                                                                             *
+ *   You should have received a copy of the GNU General Public License         *
+ *   along with this program; if not, write to the                             *
+ *   Free Software Foundation, Inc.,                                           *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.                 *
+ *******************************************************************************/
+#ifndef FMINDEX_HPP
+#define FMINDEX_HPP
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+#include "MatchFinder.hpp"
+
+// ============================================================================
+// FM INDEX CLASS
+// ============================================================================
+
+//64 rows of the BWT with the rank checkpoints at their start
+struct FMBlock {
+        uint32_t counts[4]; //occurrences of A, C, G and T before the block
+        uint32_t samples; //sampled rows before the block
+        uint32_t padding;
+        uint64_t bwt[2]; //2-bit characters, '$' and '#' are stored as A
+        uint64_t special; //rows holding '$' or '#'
+        uint64_t sampled; //rows with a sampled text position
+};
+
+//FM index over the concatenated node sequences: a 2-bit packed BWT with
+//rank checkpoints every 64 characters, the separators in a mask and a
+//text position for every sample_rate-th text position; takes about one
+//byte per reference character
+class FMIndex : public MatchFinder {
+        private:
+                std::string const &reference_; //concatenated node sequences
+                int sample_rate_; //distance between sampled text positions
+                long max_occ_; //maximum number of occurrences per MEM, 0 = all
+                long rows_; //number of rows, the text and its terminator
+                long C_[4]; //first row of the suffixes starting with A, C, G, T
+                std::vector<FMBlock> blocks_; //the BWT with rank checkpoints
+                std::vector<uint32_t> samples_; //text positions of sampled rows
+
+                //interval of BWT rows [start, end)
+                struct Interval {
+                        long start;
+                        long end;
+                        long size() const {return end - start;}
+                };
+                //occurrences of c in the first i rows
+                inline long rank(int c, long i) const;
+                //character of a row, -1 for '$' and '#'
+                inline int get_char(long row) const;
+                //extend an interval with c to the left
+                inline Interval extend(int c, Interval const &interval) const;
+                //text position of a row
+                long locate(long row) const;
+
+        public:
+                /*
+                 *        ctors
+                 */
+                FMIndex(std::string const &reference, int sample_rate,
+                        long max_occ);
+                /*
+                 *        methods
+                 */
+                //build the index by suffix sorting the reference
+                void construct();
+                //store the index in a file prefix.fmi
+                void save(std::string const &prefix) const;
+                //load the index stored by save, false if there is none
+                bool load(std::string const &prefix);
+                //maximal exact matches by backward search
+                void findMatches(std::string const &read,
+                        std::vector<bool> const *skip, mem_visitor_t &visitor,
+                        int const min_len) const;
+                long size_in_bytes() const;
+};
+
+#endif
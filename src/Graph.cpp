@@ -34,19 +34,97 @@ void Graph::addNode(std::string const &sequence, std::vector<int> const &in_edge
         seed_finder_.addNodeToReference(rc_sequence);
 }
 
+//neighbouring nodes share k - 1 bases, so a match that reaches the end of a
+//node continues at the start of a successor; the k-mers of the successors
+//differ in their last base, so at most one of them matches beyond the overlap
+void Graph::extendMatchForward(std::string const &read, std::vector<int> &path,
+        int &node_end, int &read_end, std::vector<int> &edges) const
+{
+        int overlap = k_ - 1;
+        while (read_end < read.size() && read_end >= overlap
+                && node_end == getSizeOfNode(path.back()))
+        {
+                int read_start = read_end - overlap;
+                getOutEdges(path.back(), edges);
+                int j = 0;
+                int len = 0;
+                for (; j < edges.size(); ++j) {
+                        len = seed_finder_.matchForward(edges[j], 0, read,
+                                read_start);
+                        if (len > overlap) {
+                                break;
+                        }
+                }
+                if (j == edges.size()) {
+                        return;
+                }
+                path.push_back(edges[j]);
+                node_end = len;
+                read_end = read_start + len;
+        }
+}
+
+void Graph::extendMatchBackward(std::string const &read, std::vector<int> &path,
+        int &node_start, int &read_start, std::vector<int> &edges) const
+{
+        int overlap = k_ - 1;
+        while (read_start > 0 && read_start + overlap <= read.size()
+                && node_start == 0)
+        {
+                int read_end = read_start + overlap;
+                getInEdges(path.back(), edges);
+                int j = 0;
+                int len = 0;
+                for (; j < edges.size(); ++j) {
+                        len = seed_finder_.matchBackward(edges[j],
+                                getSizeOfNode(edges[j]), read, read_end);
+                        if (len > overlap) {
+                                break;
+                        }
+                }
+                if (j == edges.size()) {
+                        return;
+                }
+                path.push_back(edges[j]);
+                node_start = getSizeOfNode(edges[j]) - len;
+                read_start = read_end - len;
+        }
+}
+
 std::vector<int> Graph::getOutEdges(int node_id) const{
+        std::vector<int> edges;
+        getOutEdges(node_id, edges);
+        return edges;
+}
+
+void Graph::getOutEdges(int node_id, std::vector<int> &edges) const{
         if (node_id > 0) {
-                return nodes_[node_id].get_out_edges();
+                edges = nodes_[node_id].get_out_edges();
         } else {
-                return nodes_[-node_id].get_rc_out_edges();
+                //the successors of the rc node are the rc predecessors
+                std::vector<int> const &in_edges = nodes_[-node_id].get_in_edges();
+                edges.resize(in_edges.size());
+                for (int i = 0; i < in_edges.size(); ++i) {
+                        edges[i] = -in_edges[i];
+                }
         }
 }
 
 std::vector<int> Graph::getInEdges(int node_id) const{
+        std::vector<int> edges;
+        getInEdges(node_id, edges);
+        return edges;
+}
+
+void Graph::getInEdges(int node_id, std::vector<int> &edges) const{
         if (node_id > 0) {
-                return nodes_[node_id].get_in_edges();
+                edges = nodes_[node_id].get_in_edges();
         } else {
-                return nodes_[-node_id].get_rc_in_edges();
+                std::vector<int> const &out_edges = nodes_[-node_id].get_out_edges();
+                edges.resize(out_edges.size());
+                for (int i = 0; i < out_edges.size(); ++i) {
+                        edges[i] = -out_edges[i];
+                }
         }
 }
 
@@ -66,36 +144,52 @@ std::string Graph::getSequenceOfNode(int node_id) const {
 }
 
 
-std::string Graph::concatenateNodes(std::vector<int> const &path) const{
+std::string Graph::concatenateNodes(NodePath path) const{
         if (path.size() == 0) {
                 return "";
         }
-        std::string result = getSequenceOfNode(path[0]);
+        std::string result;
+        result.reserve(getSizeOfPath(path));
+        seed_finder_.appendNode(path[0], 0, result);
+        std::vector<int> next;
         for (int i = 1; i < path.size(); ++i) {
                 if (path[i] == 0) {
                         continue;
                 }
-                std::vector<int> next = getOutEdges(path[i - 1]);
+                getOutEdges(path[i - 1], next);
                 if (std::find(next.begin(), next.end(), path[i]) == next.end()) {
                         std::cout << "Path does not exist\n";
                 }
-                result += getSequenceOfNode(path[i]).substr(k_ - 1);
+                seed_finder_.appendNode(path[i], k_ - 1, result);
         }
         return result;
 }
 
+int Graph::getSizeOfPath(NodePath path) const{
+        if (path.size() == 0) {
+                return 0;
+        }
+        int size = getSizeOfNode(path[0]);
+        for (int i = 1; i < path.size(); ++i) {
+                if (path[i] != 0) {
+                        size += getSizeOfNode(path[i]) - (k_ - 1);
+                }
+        }
+        return size;
+}
+
 void Graph::extendPathNosink(std::vector<int> &path, int est_dist, bool rev = 0) const{
         return extendPath(path, 0, est_dist, rev);
 }
 
 void Graph::extendPath(std::vector<int> &path, int sink, int est_dist, bool rev = 0) const{
         bool tarfound = 0;
+        std::vector<int> next;
         while (true) {
-                std::vector<int> next;
                 if (rev) {
-                        next = getInEdges(path.back());
+                        getInEdges(path.back(), next);
                 } else {
-                        next = getOutEdges(path.back());
+                        getOutEdges(path.back(), next);
                 }
                 int good_next = -2;
                 for (int i = 0; i < next.size(); ++i) {
@@ -24,13 +24,15 @@
 
 #include "SeedFinder.hpp"
 #include "Settings.hpp"
+#include "Numa.hpp"
+#include "PathArena.hpp"
 
 
 class Graph {
         private:
                 int size_; //number of nodes
                 int k_; //size of k-mers, overlap between nodes is k-1
-                std::vector<TNode> nodes_; //list of nodes
+                std::vector<TNode, HugePageAllocator<TNode> > nodes_; //list of nodes
                 Settings const &settings_;
                 SeedFinder seed_finder_;
         public:
@@ -52,19 +54,59 @@ class Graph {
                 int get_overlap() const {return k_ - 1;}
                 int get_k() const {return k_;}
                 void getSeeds(std::string const &read,
-                        std::map<int, std::vector<Seed>> &seed_map,
-                        std::vector<int> &seeds_of_size,
-                        std::vector<int> &map_keys, int &seed_count,
+                        std::vector<bool> const *skip, SeedTable &seeds,
                         int const &seed_min_length) const
                 {
-                        seed_finder_.getSeeds(read, seed_map, seeds_of_size,
-                                map_keys, seed_count, seed_min_length);
+                        seed_finder_.getSeeds(read, skip, seeds,
+                                seed_min_length);
+                        if (settings_.get_extend_seeds()) {
+                                seeds.join(read, *this);
+                        }
                 }
+                void getSeeds(std::vector<std::string const *> const &reads,
+                        std::vector<std::vector<bool> const *> const &skips,
+                        std::vector<SeedTable *> const &seeds,
+                        int const &seed_min_length) const
+                {
+                        seed_finder_.getSeeds(reads, skips, seeds,
+                                seed_min_length);
+                        if (settings_.get_extend_seeds()) {
+                                for (size_t i = 0; i < reads.size(); ++i) {
+                                        seeds[i]->join(*reads[i], *this);
+                                }
+                        }
+                }
+                void addSeeds(std::string const &read,
+                        std::vector<bool> const *skip,
+                        std::vector<std::pair<int, int> > const &segments,
+                        SeedTable &seeds, int const &seed_min_length) const
+                {
+                        seed_finder_.addSeeds(read, skip, segments, seeds,
+                                seed_min_length);
+                        if (settings_.get_extend_seeds()) {
+                                seeds.join(read, *this);
+                        }
+                }
+                //continue an exact match of the read that reaches the end of
+                //the last node of path in the successors while the read keeps
+                //matching; the successors are appended to path and node_end
+                //and read_end move to the end of the match, edges is a buffer
+                void extendMatchForward(std::string const &read,
+                        std::vector<int> &path, int &node_end, int &read_end,
+                        std::vector<int> &edges) const;
+                //idem for a match that reaches the start of the last node of
+                //path, the predecessors are appended in the order they are
+                //matched, so path runs against the direction of the read
+                void extendMatchBackward(std::string const &read,
+                        std::vector<int> &path, int &node_start,
+                        int &read_start, std::vector<int> &edges) const;
                 //setters
                 void set_k(int k) {k_ = k;}
                 //initialise the seed finder
                 void init_seed_finder(std::string const &str) {
-                        seed_finder_.init_essaMEM(str);
+                        seed_finder_.init_index(str);
+                        if (settings_.get_numa())
+                                Numa::interleave(nodes_.data(), nodes_.size() * sizeof(TNode));
                 }
                 //create a node with given sequence and neighbours
                 void addNode(std::string const &sequence,
@@ -72,14 +114,18 @@ class Graph {
                         std::vector<int> const &right_nb);
                 //get the outedges of a node
                 std::vector<int> getOutEdges(int node_id) const;
+                void getOutEdges(int node_id, std::vector<int> &edges) const;
                 //get the inedges of a node
                 std::vector<int> getInEdges(int node_id) const;
+                void getInEdges(int node_id, std::vector<int> &edges) const;
                 //get size of a node
                 int getSizeOfNode(int node_id) const;
                 //get sequence content of a node
                 std::string getSequenceOfNode(int node_id) const;
                 //get the sequence content of a path in the graph
-                std::string concatenateNodes(std::vector<int> const &path) const;
+                std::string concatenateNodes(NodePath path) const;
+                //get the size of the sequence content of a path
+                int getSizeOfPath(NodePath path) const;
                 //print the size of a path in the graph
                 void printPathLengths(int node);
                 //extend along linear path
@@ -69,6 +69,7 @@ void GraphChain::readGraph(ReadLibrary const &graph_input) {
 GraphChain::GraphChain(int argc, char * argv[]) :
         settings_(argc, argv), graph_(settings_)
 {
+        HugePages::set_mode(settings_.get_huge_pages());
         //read graph
         graph_.set_k(settings_.get_dbg_k());
         readGraph(settings_.get_graph());
@@ -0,0 +1,168 @@
+/*******************************************************************************
+ *   Copyright (C) 2014, 2015 Giles Miclotte (giles.miclotte@intec.ugent.be)   *
+ *   This file is part of Jabba                                                *
+ *                                                                             *
+ *   This program is free software; you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published by      *
+ *   the Free Software Foundation; either version 2 of the License, or         *
+ *   (at your option) any later version.                                       *
+ *                                                                             *
+ *   This program is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *   GNU General Public License for more details.                              *
+ *                                                                             *
+ *   You should have received a copy of the GNU General Public License         *
+ *   along with this program; if not, write to the                             *
+ *   Free Software Foundation, Inc.,                                           *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.                 *
+ *******************************************************************************/
+#include "HugePages.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <map>
+#include <mutex>
+#include <algorithm>
+
+#ifdef __linux__
+        #include <sys/mman.h>
+#endif
+
+HugePageMode HugePages::mode_ = HP_OFF;
+
+namespace {
+        struct Region {
+                size_t bytes; //size of the region
+                bool owned; //mapped by allocate(), as opposed to advise()
+        };
+        std::mutex regions_mutex;
+        std::map<uintptr_t, Region> regions; //regions eligible for huge pages
+
+        void add_region(void const *ptr, size_t bytes, bool owned) {
+                std::lock_guard<std::mutex> lock(regions_mutex);
+                Region region = {bytes, owned};
+                regions[(uintptr_t)ptr] = region;
+        }
+}
+
+void *HugePages::allocate(size_t bytes)
+{
+        if (mode_ == HP_OFF || bytes < page_size)
+                return ::operator new(bytes);
+#ifdef __linux__
+        size_t len = (bytes + page_size - 1) / page_size * page_size;
+#ifdef MAP_HUGETLB
+        if (mode_ == HP_HUGETLB) {
+                void *ptr = mmap(NULL, len, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+                if (ptr != MAP_FAILED) {
+                        add_region(ptr, len, true);
+                        return ptr;
+                }
+                //no huge pages reserved, fall back to transparent huge pages
+        }
+#endif
+        //over-allocate so the region can be aligned to a huge page
+        void *raw = mmap(NULL, len + page_size, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED)
+                return ::operator new(bytes);
+        uintptr_t start = (uintptr_t)raw;
+        uintptr_t aligned = (start + page_size - 1) / page_size * page_size;
+        if (aligned > start)
+                munmap(raw, aligned - start);
+        if (start + page_size > aligned)
+                munmap((void*)(aligned + len), start + page_size - aligned);
+#ifdef MADV_HUGEPAGE
+        madvise((void*)aligned, len, MADV_HUGEPAGE);
+#endif
+        add_region((void*)aligned, len, true);
+        return (void*)aligned;
+#else
+        return ::operator new(bytes);
+#endif
+}
+
+void HugePages::deallocate(void *ptr, size_t bytes)
+{
+        if (ptr == NULL)
+                return;
+        if (bytes >= page_size) {
+                std::lock_guard<std::mutex> lock(regions_mutex);
+                std::map<uintptr_t, Region>::iterator it = regions.find((uintptr_t)ptr);
+                if (it != regions.end() && it->second.owned) {
+#ifdef __linux__
+                        munmap(ptr, it->second.bytes);
+#endif
+                        regions.erase(it);
+                        return;
+                }
+        }
+        ::operator delete(ptr);
+}
+
+void HugePages::advise(void const *ptr, size_t bytes)
+{
+        if (mode_ == HP_OFF)
+                return;
+        //only whole huge pages inside the buffer can be promoted
+        uintptr_t start = ((uintptr_t)ptr + page_size - 1) / page_size * page_size;
+        uintptr_t end = ((uintptr_t)ptr + bytes) / page_size * page_size;
+        if (end <= start)
+                return;
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+        if (madvise((void*)start, end - start, MADV_HUGEPAGE) == 0)
+                add_region((void*)start, end - start, false);
+#endif
+}
+
+size_t HugePages::bytes_mapped()
+{
+        std::lock_guard<std::mutex> lock(regions_mutex);
+        size_t total = 0;
+        for (auto const &it : regions)
+                total += it.second.bytes;
+        return total;
+}
+
+size_t HugePages::bytes_on_huge_pages()
+{
+        std::lock_guard<std::mutex> lock(regions_mutex);
+        std::ifstream smaps("/proc/self/smaps");
+        size_t total = 0;
+        size_t overlap = 0; //bytes of the current mapping in our regions
+        std::string line;
+        while (std::getline(smaps, line)) {
+                std::istringstream iss(line);
+                std::string key;
+                iss >> key;
+                if (key.empty())
+                        continue;
+                if (key.back() != ':') {
+                        //header of a new mapping: "start-end perms ..."
+                        size_t dash = key.find('-');
+                        if (dash == std::string::npos)
+                                continue;
+                        uintptr_t begin = std::strtoull(key.substr(0, dash).c_str(), NULL, 16);
+                        uintptr_t end = std::strtoull(key.substr(dash + 1).c_str(), NULL, 16);
+                        overlap = 0;
+                        for (auto const &it : regions) {
+                                uintptr_t lo = std::max(begin, it.first);
+                                uintptr_t hi = std::min(end, it.first + it.second.bytes);
+                                if (lo < hi)
+                                        overlap += hi - lo;
+                        }
+                } else if (overlap > 0 && (key == "AnonHugePages:"
+                        || key == "Private_Hugetlb:" || key == "Shared_Hugetlb:"))
+                {
+                        size_t kb = 0;
+                        iss >> kb;
+                        total += std::min(overlap, kb << 10);
+                }
+        }
+        return total;
+}
@@ -0,0 +1,125 @@
+/*******************************************************************************
+ *   Copyright (C) 2014, 2015 Giles Miclotte (giles.miclotte@intec.ugent.be)   *
+ *   This file is part of Jabba                                                *
+ *                                                                             *
+ *   This program is free software; you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published by      *
+ *   the Free Software Foundation; either version 2 of the License, or         *
+ *   (at your option) any later version.                                       *
+ *                                                                             *
+ *   This program is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *   GNU General Public License for more details.                              *
+ *                                                                             *
+ *   You should have received a copy of the GNU General Public License         *
+ *   along with this program; if not, write to the                             *
+ *   Free Software Foundation, Inc.,                                           *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.                 *
+ *******************************************************************************/
+#ifndef HUGEPAGES_HPP
+#define HUGEPAGES_HPP
+
+#include <cstddef>
+#include <new>
+
+typedef enum {HP_OFF, HP_THP, HP_HUGETLB} HugePageMode;
+
+// ============================================================================
+// HUGE PAGES CLASS
+// ============================================================================
+
+/**
+ * Backs large allocations with 2 MB pages, either through transparent huge
+ * pages (madvise) or through hugetlbfs (MAP_HUGETLB). Allocations smaller
+ * than a huge page, and all allocations on systems without support, fall
+ * back to the regular heap.
+ */
+class HugePages
+{
+private:
+        static HugePageMode mode_;
+
+public:
+        static const size_t page_size = 2 << 20;
+
+        /**
+         * Select how subsequent large allocations are backed
+         * @param mode HP_OFF, HP_THP or HP_HUGETLB
+         */
+        static void set_mode(HugePageMode mode) {mode_ = mode;}
+        static HugePageMode get_mode() {return mode_;}
+
+        /**
+         * Allocate memory, on huge pages if enabled and large enough
+         * @param bytes Number of bytes to allocate
+         * @return Pointer to the memory, throws std::bad_alloc on failure
+         */
+        static void *allocate(size_t bytes);
+
+        /**
+         * Release memory obtained through allocate()
+         * @param ptr Pointer returned by allocate()
+         * @param bytes Number of bytes passed to allocate()
+         */
+        static void deallocate(void *ptr, size_t bytes);
+
+        /**
+         * Ask the kernel to back an existing buffer with huge pages
+         * @param ptr Start of the buffer
+         * @param bytes Size of the buffer
+         */
+        static void advise(void const *ptr, size_t bytes);
+
+        /**
+         * Number of bytes currently mapped for huge page backing
+         * @return The number of bytes
+         */
+        static size_t bytes_mapped();
+
+        /**
+         * Number of bytes that are actually backed by huge pages, as reported
+         * by the kernel in /proc/self/smaps
+         * @return The number of bytes
+         */
+        static size_t bytes_on_huge_pages();
+};
+
+// ============================================================================
+// HUGE PAGE ALLOCATOR CLASS
+// ============================================================================
+
+/**
+ * Standard allocator on top of HugePages, for use in std::vector
+ */
+template <typename T>
+class HugePageAllocator
+{
+public:
+        typedef T value_type;
+
+        HugePageAllocator() {}
+        template <typename U>
+        HugePageAllocator(HugePageAllocator<U> const &) {}
+
+        T *allocate(size_t n) {
+                return static_cast<T*>(HugePages::allocate(n * sizeof(T)));
+        }
+        void deallocate(T *ptr, size_t n) {
+                HugePages::deallocate(ptr, n * sizeof(T));
+        }
+        template <typename U>
+        struct rebind {typedef HugePageAllocator<U> other;};
+};
+
+template <typename T, typename U>
+bool operator==(HugePageAllocator<T> const &, HugePageAllocator<U> const &) {
+        return true;
+}
+
+template <typename T, typename U>
+bool operator!=(HugePageAllocator<T> const &, HugePageAllocator<U> const &) {
+        return false;
+}
+
+#endif
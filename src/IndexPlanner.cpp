@@ -0,0 +1,135 @@
+/*******************************************************************************
+ *   Copyright (C) 2014, 2015 Giles Miclotte (giles.miclotte@intec.ugent.be)   *
+ *   This file is part of Jabba                                                *
+ *                                                                             *
+ *   This program is free software; you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published by      *
+ *   the Free Software Foundation; either version 2 of the License, or         *
+ *   (at your option) any later version.                                       *
+ *                                                                             *
+ *   This program is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *   GNU General Public License for more details.                              *
+ *                                                                             *
+ *   You should have received a copy of the GNU General Public License         *
+ *   along with this program; if not, write to the                             *
+ *   Free Software Foundation, Inc.,                                           *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.                 *
+ *******************************************************************************/
+#include "IndexPlanner.hpp"
+#include "mummer/sparseSA.hpp"
+
+#include <cmath>
+#include <iomanip>
+#include <algorithm>
+
+//relative cost of following a suffix link, ISA lookup plus interval expansion
+static const double LINK_COST = 2.0;
+//fraction of the suffix link steps that fall back to matching from the root
+static const double RESTART_RATE = 0.1;
+
+IndexPlanner::IndexPlanner(long size, int min_k, int min_len, int kmer_size,
+        long budget)
+      :        size_(size), min_k_(min_k), min_len_(min_len),
+               kmer_size_(kmer_size), budget_(budget), chosen_(0)
+{
+}
+
+IndexPlan IndexPlanner::evaluate(int k, bool suflink, bool child, bool kmer) const {
+        IndexPlan p;
+        p.k = k;
+        p.suflink = suflink;
+        p.child = child;
+        p.kmer = kmer;
+        long nk = size_ / k + 1;
+        p.index_bytes = nk * (long)(sizeof(unsigned int) + sizeof(unsigned char));
+        if (suflink)
+                p.index_bytes += nk * (long)sizeof(int);
+        if (child)
+                p.index_bytes += nk * (long)sizeof(int);
+        if (kmer)
+                p.index_bytes += (1L << (2 * kmer_size_)) * (long)sizeof(saTuple_t);
+        long in_memory = sparseSA::construction_peak_bytes(size_, k, suflink,
+                child, kmer, kmer_size_, false);
+        p.staged = budget_ > 0 && in_memory > budget_;
+        p.build_bytes = p.staged ? sparseSA::construction_peak_bytes(size_, k,
+                suflink, child, kmer, kmer_size_, true) : in_memory;
+        p.fits = budget_ <= 0
+                || (p.index_bytes <= budget_ && p.build_bytes <= budget_);
+        //findMEM queries every k-th read position, matching up to the
+        //shortened minimal length from the root or, with suffix links, k
+        //characters from the previous interval; every character is a child
+        //table lookup or a binary search over the interval
+        double log_n = std::log2(std::max<double>(2.0, nk));
+        int depth = std::max(1, min_len_ - (k - 1));
+        double step = child ? 1.0 : log_n;
+        double restart = std::max(0, depth - (kmer ? kmer_size_ : 0)) * step;
+        double query = suflink ? k * step + LINK_COST + RESTART_RATE * restart
+                               : restart;
+        //left extension of the hits is linear in k
+        query += k;
+        p.cost = query / k;
+        return p;
+}
+
+IndexPlan const &IndexPlanner::plan() {
+        candidates_.clear();
+        //MEMs shorter than the sparseness factor can not be found
+        int max_k = std::max(min_k_, min_len_);
+        int frugal = -1;
+        chosen_ = -1;
+        for (int k = min_k_; k <= max_k && chosen_ < 0; ++k) {
+                //the kmer table is only consulted when the shortened
+                //minimal length covers a full kmer
+                bool use_kmer = min_len_ - (k - 1) >= kmer_size_;
+                for (int c = 0; c < 8; ++c) {
+                        bool suflink = !(c & 1);
+                        bool child = !(c & 2);
+                        bool kmer = !(c & 4);
+                        if (kmer && !use_kmer)
+                                continue;
+                        candidates_.push_back(evaluate(k, suflink, child, kmer));
+                        IndexPlan const &p = candidates_.back();
+                        int i = candidates_.size() - 1;
+                        if (p.fits && (chosen_ < 0 || p.cost < candidates_[chosen_].cost))
+                                chosen_ = i;
+                        if (frugal < 0 || std::max(p.index_bytes, p.build_bytes)
+                                < std::max(candidates_[frugal].index_bytes,
+                                        candidates_[frugal].build_bytes))
+                                frugal = i;
+                }
+        }
+        if (chosen_ < 0) {
+                std::cerr << "Warning: the index does not fit within "
+                        << (budget_ >> 20) << " MB." << std::endl;
+                chosen_ = frugal;
+        }
+        return candidates_[chosen_];
+}
+
+void IndexPlanner::printReport(std::ostream &out) const {
+        std::ios::fmtflags flags = out.flags();
+        std::streamsize precision = out.precision();
+        out << "Index plans for " << size_ << " bases";
+        if (budget_ > 0)
+                out << " within " << (budget_ >> 20) << " MB";
+        out << " (cost is per read base, lower is faster):" << std::endl;
+        out << "    K suflink child kmer staged  index MB  build MB     cost" << std::endl;
+        for (size_t i = 0; i < candidates_.size(); ++i) {
+                IndexPlan const &p = candidates_[i];
+                out << ((int)i == chosen_ ? "*" : (p.fits ? " " : "-"))
+                        << std::setw(4) << p.k
+                        << std::setw(8) << p.suflink
+                        << std::setw(6) << p.child
+                        << std::setw(5) << p.kmer
+                        << std::setw(7) << p.staged
+                        << std::setw(10) << (p.index_bytes >> 20)
+                        << std::setw(10) << (p.build_bytes >> 20)
+                        << std::setw(9) << std::fixed << std::setprecision(2)
+                        << p.cost << std::endl;
+        }
+        out << "* chosen, - does not fit" << std::endl;
+        out.flags(flags);
+        out.precision(precision);
+}
@@ -0,0 +1,74 @@
+/*******************************************************************************
+ *   Copyright (C) 2014, 2015 Giles Miclotte (giles.miclotte@intec.ugent.be)   *
+ *   This file is part of Jabba                                                *
+ *                                                                             *
+ *   This program is free software; you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published by      *
+ *   the Free Software Foundation; either version 2 of the License, or         *
+ *   (at your option) any later version.                                       *
+ *                                                                             *
+ *   This program is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *   GNU General Public License for more details.                              *
+ *                                                                             *
+ *   You should have received a copy of the GNU General Public License         *
+ *   along with this program; if not, write to the                             *
+ *   Free Software Foundation, Inc.,                                           *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.                 *
+ *******************************************************************************/
+#ifndef INDEXPLANNER_HPP
+#define INDEXPLANNER_HPP
+
+#include <vector>
+#include <iostream>
+
+// ============================================================================
+// INDEX PLANNER CLASS
+// ============================================================================
+
+//one way of building the enhanced sparse suffix array
+struct IndexPlan {
+        int k; //sparseness factor
+        bool suflink; //use suffix links
+        bool child; //use child arrays
+        bool kmer; //use kmer table
+        bool staged; //build the index straight to disk
+        long index_bytes; //size of the loaded index
+        long build_bytes; //peak memory while building the index
+        double cost; //predicted search cost per read base, lower is faster
+        bool fits; //both the build and the loaded index fit the budget
+};
+
+//predicts the memory use and search speed of the possible index
+//configurations and picks the fastest one that fits the memory budget
+class IndexPlanner {
+        private:
+                long size_; //length of the text that is indexed
+                int min_k_; //smallest sparseness factor allowed
+                int min_len_; //minimal seed length
+                int kmer_size_; //kmer size for the kmer table
+                long budget_; //memory budget in bytes, 0 = unlimited
+                std::vector<IndexPlan> candidates_; //all evaluated plans
+                int chosen_; //index of the chosen plan in candidates_
+
+                //fill in the predictions for a single configuration
+                IndexPlan evaluate(int k, bool suflink, bool child, bool kmer) const;
+
+        public:
+                /*
+                 *        ctors
+                 */
+                IndexPlanner(long size, int min_k, int min_len, int kmer_size,
+                        long budget);
+                /*
+                 *        methods
+                 */
+                //evaluate all configurations and choose one
+                IndexPlan const &plan();
+                //the chosen plan, plan() must have been called
+                IndexPlan const &get_plan() const {return candidates_[chosen_];}
+                //print the evaluated configurations
+                void printReport(std::ostream &out) const;
+};
+#endif
@@ -20,27 +20,29 @@
 #ifndef INEXACTSEED_HPP
 #define INEXACTSEED_HPP
 
-#include <vector>
-
 #include "Seed.hpp"
 
 class InexactSeed{
 private:
-        std::vector<Seed> seeds_; //list of exact seeds that make this inexact seed
+        //first and last of the chain of exact seeds that make this inexact seed
+        Seed front_;
+        Seed back_;
 public:
         /*
          *        ctors
          */
-        InexactSeed(std::vector<Seed> seeds) : seeds_(seeds){}
+        InexactSeed(Seed const &front, Seed const &back)
+                : front_(front), back_(back) {}
         /*
          *        getters
          */
-        std::vector<Seed> get_seeds() const {return seeds_;}
-        int get_node() const {return seeds_[0].get_node();}
-        int get_node_start() const {return seeds_[0].get_ref_start();}
-        int get_node_end() const {return seeds_.back().get_ref_end();}
-        int get_read_start() const {return seeds_[0].get_read_start();}
-        int get_read_end() const {return seeds_.back().get_read_end();}
+        int get_node() const {return front_.get_node();}
+        int get_node_start() const {return front_.get_ref_start();}
+        int get_node_end() const {return back_.get_ref_end();}
+        int get_read_start() const {return front_.get_read_start();}
+        int get_read_end() const {return back_.get_read_end();}
+        //the chain ends in the nodes of its last seed
+        int get_path() const {return back_.get_path();}
         /*
          *        methods
          */
@@ -29,34 +29,24 @@
 //ctors
 
 InterNodeChain::InterNodeChain(Read const &read, Graph const &graph,
-        Settings const &settings, Alignment &alignment)
+        Settings const &settings, CorrectionContext &context,
+        SeedTable &seeds)
  :        read_(read),
         graph_(graph),
         settings_(settings),
-        seed_map_(),
-        map_keys_(),
-        seeds_of_size_(),
+        seeds_(seeds),
         max_passes_(settings.get_max_passes()),
-        alignment_(alignment)
+        context_(context)
 {
-        int seed_min_len = settings_.get_min_len();
-        int seed_count = 0;
-        seeds_of_size_.clear();
-        map_keys_.clear();
-        seed_map_.clear();
-        graph_.getSeeds(read_.get_sequence(), seed_map_, seeds_of_size_,
-                map_keys_, seed_count, seed_min_len);
+        context_.clear();
         //printSeeds();
 }
 
 //methods
 
 void InterNodeChain::printSeeds() {
-        for (int j = 0; j < map_keys_.size(); ++j) {
-                for (int k = 0; k < seed_map_[map_keys_[j]].size(); ++k) {
-                        Seed s = seed_map_[map_keys_[j]][k];
-                        std::cerr << s.to_string() << std::endl;
-                }
+        for (int i = 0; i < seeds_.size(); ++i) {
+                std::cerr << seeds_[i].to_string() << std::endl;
         }
 }
 
@@ -85,19 +75,21 @@ bool InterNodeChain::seedIsSuperMaximal(
 
 //this function determines if an inexact seed gives a realistic covering
 //of a node, given the error profile and minimal MEM size
-bool InterNodeChain::seedCoversNode(InexactSeed seed) const {
+bool InterNodeChain::seedCoversNode(InexactSeed const &seed) const {
         //start of the (crudely) estimated covered region c
         int c_start = seed.get_node_start() - seed.get_read_start();
         c_start = c_start > 0 ? c_start : 0;
         //end of c
         int c_end = seed.get_node_end()
-                + (read_.get_sequence().size() - seed.get_read_end());
+                + (read_.size() - seed.get_read_end());
         c_end = c_end < graph_.getSizeOfNode(seed.get_node())
                         ? c_end : graph_.getSizeOfNode(seed.get_node());
         return 5 * (seed.get_node_end() - seed.get_node_start()) > (c_end - c_start);
 }
 
-bool InterNodeChain::seedIsSufficientlyBig(InexactSeed seed, int pass) const {
+bool InterNodeChain::seedIsSufficientlyBig(InexactSeed const &seed,
+        int pass) const
+{
         return seed.get_node_end() - seed.get_node_start() > 50 - 5 * pass;
 }
 
@@ -105,7 +97,8 @@ void InterNodeChain::filterSeedsGlobal(std::vector<InexactSeed> &inexact_seeds,
         int pass) const
 {
         std::sort(inexact_seeds.begin(), inexact_seeds.end());
-        std::vector<int> remove_seed;
+        std::vector<int> &remove_seed = context_.removed_seeds;
+        remove_seed.clear();
         //first we loop through the seeds to see which ones are worth keeping
         for (int index = 0; index < inexact_seeds.size(); ++index) {
                 bool seed_is_high_qual = seedIsSuperMaximal(inexact_seeds, index);
@@ -123,21 +116,17 @@ void InterNodeChain::filterSeedsGlobal(std::vector<InexactSeed> &inexact_seeds,
         }
 }
 
-void InterNodeChain::countSeedsInSegment(int const &read_segment_start,
-        int const &read_segment_end, std::vector<int> &seeds_in_segment_of_size,
-        int &seeds_in_segment)
+void InterNodeChain::countSeedsInSegment(
+        std::vector<int> const &segment_seeds,
+        std::vector<int> &seeds_in_segment_of_size, int &seeds_in_segment)
 {
-        for (int j = 0; j < map_keys_.size(); ++j) {
-                for (int k = 0; k < seed_map_[map_keys_[j]].size(); ++k) {
-                        Seed s = seed_map_[map_keys_[j]][k];
-                        if (s.isInReadSegment(read_segment_start, read_segment_end)) {
-                                while (seeds_in_segment_of_size.size() < s.get_length() + 1) {
-                                        seeds_in_segment_of_size.push_back(0);
-                                }
-                                ++seeds_in_segment_of_size[s.get_length()];
-                                ++seeds_in_segment;
-                        }
+        for (int i = 0; i < segment_seeds.size(); ++i) {
+                Seed const &s = seeds_[segment_seeds[i]];
+                while (seeds_in_segment_of_size.size() < s.get_length() + 1) {
+                        seeds_in_segment_of_size.push_back(0);
                 }
+                ++seeds_in_segment_of_size[s.get_length()];
+                ++seeds_in_segment;
         }
 }
 
@@ -157,67 +146,75 @@ int InterNodeChain::findSeedTreshold(
         return seed_size_treshold;
 }
 
-std::vector<int> InterNodeChain::extractListOfNodesToChain(
-        int const &read_segment_start, int const &read_segment_end, 
-        int const &seed_size_treshold)
+void InterNodeChain::extractListOfNodesToChain(
+        std::vector<int> const &segment_seeds, int const &seed_size_treshold,
+        std::vector<int> &probable_nodes)
 {
-        std::vector<int> probable_nodes;
-        for (int j = 0; j < map_keys_.size(); ++j) {
-                for (int k = 0; k < seed_map_[map_keys_[j]].size(); ++k) {
-                        Seed s = seed_map_[map_keys_[j]][k];
-                        if (s.isInReadSegment(read_segment_start, read_segment_end)
-                                && s.get_length() >= seed_size_treshold) {
-                                probable_nodes.push_back(map_keys_[j]);
-                                break;
-                        }
+        //the seeds of the segment are in table order, so grouped per node
+        probable_nodes.clear();
+        int range = 0;
+        for (int i = 0; i < segment_seeds.size(); ++i) {
+                while (seeds_.get_range(range).end <= segment_seeds[i]) {
+                        ++range;
+                }
+                if (seeds_[segment_seeds[i]].get_length() >= seed_size_treshold
+                        && (probable_nodes.empty() || probable_nodes.back() != range))
+                {
+                        probable_nodes.push_back(range);
                 }
         }
-        return probable_nodes;
 }
 
 
-std::vector<InexactSeed> InterNodeChain::organiseIntraNodeChaining(
-        int const &segment_start, int const &segment_end,
-        std::vector<int> probable_nodes)
+void InterNodeChain::organiseIntraNodeChaining(
+        std::vector<int> const &segment_seeds,
+        std::vector<int> const &probable_nodes,
+        std::vector<InexactSeed> &inexact_seeds)
 {
-        std::vector<InexactSeed> inexact_seeds;
+        inexact_seeds.clear();
+        std::vector<Seed> &seeds_in_segment = context_.node_seeds;
+        int i = 0;
         for (int j = 0; j < probable_nodes.size(); ++j) {
-                std::vector<Seed> seeds_in_segment;
-                for (int k = 0; k < seed_map_[probable_nodes[j]].size(); ++k) {
-                        Seed s = seed_map_[probable_nodes[j]][k];
-                        if (s.isInReadSegment(segment_start, segment_end)) {
-                                seeds_in_segment.push_back(s);
-                        }
+                NodeRange const &range = seeds_.get_range(probable_nodes[j]);
+                seeds_in_segment.clear();
+                while (segment_seeds[i] < range.begin) {
+                        ++i;
                 }
-                IntraNodeChain ianc(seeds_in_segment, settings_);
+                for (; i < segment_seeds.size() && segment_seeds[i] < range.end; ++i) {
+                        seeds_in_segment.push_back(seeds_[segment_seeds[i]]);
+                }
+                IntraNodeChain ianc(seeds_in_segment, settings_, context_);
                 ianc.groupSeedsInNode(inexact_seeds);
         }
-        return inexact_seeds;
 }
 
 //filters seeds within nodes
-std::vector<InexactSeed> InterNodeChain::filterSeedsLocal(
-        std::pair<int, int> const &segment)
+void InterNodeChain::filterSeedsLocal(std::pair<int, int> const &segment,
+        std::vector<InexactSeed> &inexact_seeds)
 {
-        return filterSeedsLocal(segment.first, segment.second);
+        filterSeedsLocal(segment.first, segment.second, inexact_seeds);
 }
 
-std::vector<InexactSeed> InterNodeChain::filterSeedsLocal(
+void InterNodeChain::filterSeedsLocal(
                 int const &read_segment_start,
-                int const &read_segment_end) {
+                int const &read_segment_end,
+                std::vector<InexactSeed> &inexact_seeds) {
                 //(1) find the biggest MEMs
-        std::vector<int> seeds_in_segment_of_size;
+        std::vector<int> &segment_seeds = context_.segment_seeds;
+        seeds_.getSeedsInSegment(read_segment_start, read_segment_end,
+                segment_seeds);
+        std::vector<int> &seeds_in_segment_of_size = context_.seeds_of_size;
+        seeds_in_segment_of_size.clear();
         int seeds_in_segment = 0;
-        countSeedsInSegment(read_segment_start, read_segment_end,
-                seeds_in_segment_of_size, seeds_in_segment);
+        countSeedsInSegment(segment_seeds, seeds_in_segment_of_size,
+                seeds_in_segment);
         int seed_size_treshold = findSeedTreshold(seeds_in_segment_of_size,
                 seeds_in_segment, 5 + 10 * (0 == read_segment_start));
-        std::vector<int> probable_nodes = extractListOfNodesToChain(
-                read_segment_start, read_segment_end, seed_size_treshold);
+        std::vector<int> &probable_nodes = context_.probable_nodes;
+        extractListOfNodesToChain(segment_seeds, seed_size_treshold,
+                probable_nodes);
                 //(2) locally chain the nodes containing these MEMs
-        std::vector<InexactSeed> inexact_seeds = organiseIntraNodeChaining(
-                read_segment_start, read_segment_end, probable_nodes);
-        return inexact_seeds;
+        organiseIntraNodeChaining(segment_seeds, probable_nodes, inexact_seeds);
 }
 
 std::pair<int, int> InterNodeChain::alignCorrectedToRead(std::string &corrected,
@@ -236,9 +233,9 @@ std::pair<int, int> InterNodeChain::alignCorrectedToRead(std::string &corrected,
         std::string corrected_p = corrected.substr(0, size);
         std::cout << read_p << std::endl;
         std::cout << corrected_p << std::endl;
-        int score = alignment_.align(read_p, corrected_p);
+        int score = context_.alignment.align(read_p, corrected_p);
         std::cout << "score: " << score << std::endl;
-        alignment_.printAlignment(read_p, corrected_p);
+        context_.alignment.printAlignment(read_p, corrected_p);
         
         return std::pair<int, int> (0, 0);
 }
@@ -249,18 +246,18 @@ void InterNodeChain::filterOverlappingSeeds(
         std::vector<InexactSeed> &inexact_seeds) const
 {
         for (int i = 0; i < inexact_seeds.size(); ++i) {
-                InexactSeed isi = inexact_seeds[i];
+                InexactSeed const &isi = inexact_seeds[i];
                 std::vector<int> next = graph_.getOutEdges(isi.get_node());
         }
         std::vector<InexactSeed> filtered;
         for (int i = 0; i < inexact_seeds.size(); ++i) {
-                InexactSeed curr_is = inexact_seeds[i];
+                InexactSeed const &curr_is = inexact_seeds[i];
                 int j = 0;
                 for (; j < inexact_seeds.size(); ++j) {
                         if (i == j) {
                                 continue;
                         }
-                        InexactSeed other_is = inexact_seeds[j];
+                        InexactSeed const &other_is = inexact_seeds[j];
                         if (other_is.get_read_start() - 2 < curr_is.get_read_start()
                                 && curr_is.get_read_end() < other_is.get_read_end() + 2)
                         {
@@ -273,54 +270,93 @@ void InterNodeChain::filterOverlappingSeeds(
         }
         inexact_seeds = filtered;
         for (int i = 0; i < inexact_seeds.size(); ++i) {
-                InexactSeed isi = inexact_seeds[i];
+                InexactSeed const &isi = inexact_seeds[i];
                 std::vector<int> next = graph_.getOutEdges(isi.get_node());
         }
 }
 
-std::vector<LocalAlignment> InterNodeChain::correctRead(
-        std::vector<InexactSeed> inexact_seeds)
+PathExtension const &InterNodeChain::extendNode(int node) {
+        std::vector<std::pair<int, int>> &index = context_.extension_index;
+        auto it = std::lower_bound(index.begin(), index.end(),
+                std::make_pair(node, -1));
+        if (it != index.end() && it->first == node) {
+                return context_.extensions[it->second];
+        }
+        //reuse the storage of the extensions of earlier reads
+        int slot = context_.num_extensions++;
+        if (slot == context_.extensions.size()) {
+                context_.extensions.push_back(PathExtension());
+        }
+        index.insert(it, std::make_pair(node, slot));
+        PathExtension &ext = context_.extensions[slot];
+        ext.pre_path.clear();
+        ext.post_path.clear();
+        ext.pre_path.push_back(node);
+        graph_.extendPath(ext.pre_path, 0, 1000000, true);
+        std::reverse(ext.pre_path.begin(), ext.pre_path.end());
+        ext.pre_size = graph_.getSizeOfPath(ext.pre_path);
+        ext.post_path.push_back(node);
+        graph_.extendPath(ext.post_path, 0, 1000000, false);
+        ext.post_size = graph_.getSizeOfPath(ext.post_path);
+        return ext;
+}
+
+void InterNodeChain::correctRead(
+        std::vector<InexactSeed> const &inexact_seeds,
+        std::vector<LocalAlignment> &alignments)
 {
-        std::vector<LocalAlignment> alignments;
+        std::vector<int> &anchor_path = context_.anchor_path;
+        alignments.resize(inexact_seeds.size());
         for (int i = 0; i < inexact_seeds.size(); ++i) {
-                InexactSeed is = inexact_seeds[i];
-                LocalAlignment la;
-
+                InexactSeed const &is = inexact_seeds[i];
+                LocalAlignment &la = alignments[i];
+                //a chain ending in a seed joined along the graph runs through
+                //the nodes of that seed, its end is an offset in their path
+                int node_start = is.get_node_start();
+                int read_start = is.get_read_start();
+                int read_end = is.get_read_end();
+                seeds_.getPath(is.get_node(), is.get_path(), anchor_path);
+                int first_node = anchor_path.front();
+                int last_node = anchor_path.back();
+                int node_end = is.get_node_end();
+                if (anchor_path.size() > 1) {
+                        node_end -= graph_.getSizeOfPath(anchor_path)
+                                - graph_.getSizeOfNode(last_node);
+                }
 
-                std::vector<int> pre_path;
-                pre_path.push_back(is.get_node());
-                graph_.extendPath(pre_path, 0, 1000000, true);
-                std::reverse(pre_path.begin(), pre_path.end());
-                std::string pre_path_seq = graph_.concatenateNodes(pre_path);
+                PathExtension const &pre_ext = extendNode(first_node);
+                //the path is built at the end of the arena of the read
+                PathArena &paths = context_.paths;
+                int path_start = paths.size();
+                paths.append(pre_ext.pre_path);
+                paths.append(NodePath(anchor_path.data() + 1,
+                        anchor_path.data() + anchor_path.size()));
                 //std::cout << "Inexact Seed: " << is.get_node() << " " << is.get_node_start() << " " << is.get_node_end() << " " << is.get_read_start() << " " << is.get_read_end() << std::endl;
-                int pre_path_size = pre_path_seq.size() - (graph_.getSizeOfNode(is.get_node()) - is.get_node_start());
-                pre_path_seq = pre_path_seq.substr(0, pre_path_size);
-                if (is.get_read_start() > pre_path_seq.size()) {
+                int pre_path_size = pre_ext.pre_size - (graph_.getSizeOfNode(first_node) - node_start);
+                if (read_start > pre_path_size) {
                         //std::string r = read_.get_sequence().substr(0, is.get_read_start());
                         //la.set_read_start(alignCorrectedToRead(pre_path_seq, r).first);
-                        la.set_read_start(is.get_read_start()); //TODO
-                        la.set_ref_start(pre_path_seq.size());
+                        la.set_read_start(read_start); //TODO
+                        la.set_ref_start(pre_path_size);
                 } else {
                         la.set_read_start(0);
-                        la.set_ref_start(pre_path_seq.size() - is.get_read_start());
+                        la.set_ref_start(pre_path_size - read_start);
                 }
 
 
-                std::vector<int> post_path;
-                post_path.push_back(is.get_node());
-                graph_.extendPath(post_path, 0, 1000000, false);
-                std::string post_path_seq = graph_.concatenateNodes(post_path);
-                int post_path_start = is.get_node_end();
-                if (post_path_start < post_path_seq.size()) {
-                        post_path_seq = post_path_seq.substr(post_path_start);
-                } else {
-                        post_path_seq = "";
+                //extending the last node may move the extension of the first
+                PathExtension const &post_ext = extendNode(last_node);
+                std::vector<int> const &post_path = post_ext.post_path;
+                int post_path_start = node_end;
+                int post_path_size = 0;
+                if (post_path_start < post_ext.post_size) {
+                        post_path_size = post_ext.post_size - post_path_start;
                 }
-                if (read_.size() - is.get_read_end() >= post_path_seq.size()) {
+                if (read_.size() - read_end >= post_path_size) {
                         //std::string r = read_.get_sequence().substr(is.get_read_end());
                         //la.set_read_end(alignCorrectedToRead(pre_path_seq, r).second);
-                        la.set_read_end(is.get_read_end()); //TODO
-                        la.set_ref_end(la.get_ref_start() + is.get_read_end() - is.get_read_start());
+                        la.set_read_end(read_end); //TODO
+                        la.set_ref_end(la.get_ref_start() + read_end - read_start);
                 } else {
                         la.set_read_end(read_.size());
                         la.set_ref_end(la.get_ref_start() + read_.size());
@@ -329,22 +365,80 @@ std::vector<LocalAlignment> InterNodeChain::correctRead(
 
 
                 for (int j = 1; j < post_path.size(); ++j) {
-                        pre_path.push_back(post_path[j]);
+                        paths.push_back(post_path[j]);
                 }
-                la.set_path(pre_path);
+                la.set_path(paths, path_start, paths.size() - path_start);
                 //std::cout << "Local Alignment: " << la.to_string(read_.get_id()) << std::endl;
-                alignments.push_back(la);
         }
-        return alignments;
+}
+
+bool InterNodeChain::reseed(AlignedRead &ar, int stage) {
+        std::vector<std::pair<int, int>> segments = ar.not_corrected();
+        if (segments.empty()) {
+                return false;
+        }
+        int min_len = settings_.get_stage_min_len(stage);
+        std::vector<bool> skip;
+        if (settings_.get_min_quality() > 0) {
+                read_.getLowQualityMask(settings_.get_min_quality(), min_len,
+                        skip);
+        }
+        graph_.addSeeds(read_.get_sequence(), skip.empty() ? NULL : &skip,
+                segments, seeds_, min_len);
+        //the chains were built from the seeds of the previous stage
+        context_.num_segment_chains = 0;
+        return true;
+}
+
+void InterNodeChain::alignSeeds(AlignedRead &ar) {
+        //the seeds of the first stage are found by the caller, later stages
+        //only search the segments that are still uncorrected
+        for (int stage = 0; stage < settings_.get_seed_stages(); ++stage) {
+                if (stage > 0 && !reseed(ar, stage)) {
+                        break;
+                }
+                chainPasses(ar);
+        }
 }
 
 void InterNodeChain::chainSeeds(AlignedRead &ar, std::vector<std::string> &corrections) {
+        alignSeeds(ar);
+        //chainPaths(ar);
+        ar.getCorrectedRead(graph_, corrections);
+}
+
+void InterNodeChain::chainPasses(AlignedRead &ar) {
         for (int i = 0; i < max_passes_; ++i) {
-                std::vector<std::pair<int, int>> segments
-                        = ar.not_corrected();
+                std::vector<std::pair<int, int>> &segments = context_.segments;
+                ar.not_corrected(segments);
+                //the chains of a segment only depend on its bounds, only the
+                //segments corrected in the last pass are chained again
+                std::vector<SegmentChains> &last = context_.segment_chains;
+                std::vector<SegmentChains> &chains = context_.next_segment_chains;
+                auto last_end = last.begin() + context_.num_segment_chains;
+                if (chains.size() < segments.size()) {
+                        chains.resize(segments.size());
+                }
                 for (int j = 0; j < segments.size(); ++j) {
-                        std::vector<InexactSeed> inexact_seeds
-                                = filterSeedsLocal(segments[j]);
+                        chains[j].segment = segments[j];
+                        auto it = std::lower_bound(last.begin(), last_end,
+                                segments[j], [](SegmentChains const &a,
+                                        std::pair<int, int> const &b)-> bool
+                        {
+                                return a.segment < b;
+                        });
+                        if (it != last_end && it->segment == segments[j]) {
+                                chains[j].chains.swap(it->chains);
+                        } else {
+                                filterSeedsLocal(segments[j], chains[j].chains);
+                        }
+                }
+                last.swap(chains);
+                context_.num_segment_chains = segments.size();
+                std::vector<InexactSeed> &inexact_seeds = context_.inexact_seeds;
+                std::vector<LocalAlignment> &alignments = context_.alignments;
+                for (int j = 0; j < segments.size(); ++j) {
+                        inexact_seeds = last[j].chains;
                         //std::cout << inexact_seeds.size() << " inexact seeds initial\n";
                         if (inexact_seeds.size() == 0) {
                                 continue;
@@ -359,14 +453,11 @@ void InterNodeChain::chainSeeds(AlignedRead &ar, std::vector<std::string> &corre
                         if (inexact_seeds.size() == 0) {
                                 continue;
                         }
-                        std::vector<LocalAlignment> alignments
-                                = correctRead(inexact_seeds);
+                        correctRead(inexact_seeds, alignments);
                         ar.correct(alignments);
                 }
                 //chainPaths(ar);
         }
-        //chainPaths(ar);
-        ar.getCorrectedRead(graph_, corrections);
 }
 
 void InterNodeChain::chainPaths(AlignedRead &ar) const {
@@ -390,21 +481,21 @@ void InterNodeChain::chainPaths(AlignedRead &ar) const {
                         continue;
                 }
                 //std::cout << "path found\n";
-                std::vector<int> new_path = prev_la.get_path();
-                std::vector<int> next_path = curr_la.get_path();
-                for (int j = 1; j < path.size(); ++j) {
-                        new_path.push_back(path[j]);
+                NodePath next_path = curr_la.get_path();
+                if (path.size() > 1) {
+                        prev_la.extend_path(NodePath(path.data() + 1,
+                                path.data() + path.size()));
                 }
-                for (int j = 1; j < next_path.size(); ++j) {
-                        new_path.push_back(next_path[j]);
+                if (next_path.size() > 1) {
+                        prev_la.extend_path(NodePath(next_path.begin() + 1,
+                                next_path.end()));
                 }
-                prev_la.set_path(new_path);
                 prev_la.set_read_end(curr_la.get_read_end());
                 prev_la.set_ref_end(prev_la.get_ref_start() + prev_la.get_read_end() - prev_la.get_read_start());
                 las[i - 1] = prev_la;
                 las.erase(las.begin() + i);
                 --i;
         }
-        ar.set_local_alignments(las);
+        ar.set_local_alignments(std::move(las));
 }
 
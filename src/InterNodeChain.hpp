@@ -23,27 +23,27 @@
 #include <vector>
 #include <map>
 
-#include "Alignment.hpp"
+#include "CorrectionContext.hpp"
 
 class AlignedRead;
 class Seed;
 class Graph;
 class SeedFinder;
 class Read;
-class InexactSeed;
 class LocalAlignment;
 class Settings;
+class SeedTable;
 
 class InterNodeChain{
         private:
                 Read const &read_; //reference to the read
                 Graph const &graph_; //reference to the graph
                 Settings const &settings_; //reference to the settings
-                std::map<int, std::vector<Seed>> seed_map_; //map containing all seeds
-                std::vector<int> map_keys_; //list of all nodes that have seeds
-                std::vector<int> seeds_of_size_; //number of seeds with a given length
+                SeedTable &seeds_; //all seeds, grouped per node
                 int max_passes_; //max number of passes of the algorithm
-                Alignment &alignment_;
+                //buffers of the worker, holding the chained seeds of the
+                //segments of the last pass and the path extensions
+                CorrectionContext &context_;
                 /*
                  *        methods
                  */
@@ -55,17 +55,17 @@ class InterNodeChain{
                         std::vector<InexactSeed> const &seeds,
                         int const &index) const;
                 //check if the inexact seed sufficiently covers the node
-                bool seedCoversNode(InexactSeed seed) const;
+                bool seedCoversNode(InexactSeed const &seed) const;
                 //check if the inexact seed is large enough
-                bool seedIsSufficientlyBig(InexactSeed seed, int pass) const;
+                bool seedIsSufficientlyBig(InexactSeed const &seed, int pass)
+                        const;
                 //filter the seeds in global context
                 void filterSeedsGlobal(
                         std::vector<InexactSeed> &inexact_seeds,
                         int pass) const;
                 //count all the seeds contained in a segment of the read
                 void countSeedsInSegment(
-                        int const &read_segment_start,
-                        int const &read_segment_end, 
+                        std::vector<int> const &segment_seeds,
                         std::vector<int> &seeds_in_segment_of_size,
                         int &seeds_in_segment);
                 //find the size treshold for which seeds should be considered
@@ -73,29 +73,38 @@ class InterNodeChain{
                         std::vector<int> &seeds_in_segment_of_size,
                         int &seeds_in_segment, int const &seed_count_treshold)
                         const;
-                //get the list of nodes that should be chained
-                std::vector<int> extractListOfNodesToChain(
-                        int const &read_segment_start,
-                        int const &read_segment_end,
-                        int const &seed_size_treshold);
+                //get the list of nodes that should be chained, as indices
+                //of their ranges in the seed table
+                void extractListOfNodesToChain(
+                        std::vector<int> const &segment_seeds,
+                        int const &seed_size_treshold,
+                        std::vector<int> &probable_nodes);
                 //organise the chaining of nodes within seeds
-                std::vector<InexactSeed> organiseIntraNodeChaining(
-                        int const &segment_start, int const &segment_end,
-                        std::vector<int> probable_nodes);
+                void organiseIntraNodeChaining(
+                        std::vector<int> const &segment_seeds,
+                        std::vector<int> const &probable_nodes,
+                        std::vector<InexactSeed> &inexact_seeds);
                 //filter the seeds locally
-                std::vector<InexactSeed> filterSeedsLocal(
-                        std::pair<int, int> const &segment);
+                void filterSeedsLocal(std::pair<int, int> const &segment,
+                        std::vector<InexactSeed> &inexact_seeds);
                 //filter the seeds locally
-                std::vector<InexactSeed> filterSeedsLocal(
-                        int const &read_segment_start,
-                        int const &read_segment_end);
+                void filterSeedsLocal(int const &read_segment_start,
+                        int const &read_segment_end,
+                        std::vector<InexactSeed> &inexact_seeds);
                 //align a possible correction to the read
                 //returns the segment of the read that aligns
                 std::pair<int, int> alignCorrectedToRead(std::string &corrected,
                         std::string &read);
+                //extend a node along unique paths, cached per node
+                PathExtension const &extendNode(int node);
                 //correct the read segment
-                std::vector<LocalAlignment> correctRead(
-                        std::vector<InexactSeed> inexact_seeds);
+                void correctRead(std::vector<InexactSeed> const &inexact_seeds,
+                        std::vector<LocalAlignment> &alignments);
+                //correct the uncorrected segments with the current seeds
+                void chainPasses(AlignedRead &ar);
+                //reseed the uncorrected segments of the read with the minimal
+                //seed length of a stage, false if the read is fully corrected
+                bool reseed(AlignedRead &ar, int stage);
                 //chain the paths
                 void chainPaths(AlignedRead &ar) const;
                 //perform final chaining step by looking for paths in the graph
@@ -108,12 +117,16 @@ class InterNodeChain{
                  *        ctors
                  */
                 InterNodeChain(Read const &read, Graph const &graph,
-                        Settings const &settings, Alignment &alignment);
+                        Settings const &settings, CorrectionContext &context,
+                        SeedTable &seeds);
                 /*
                  *        methods
                  */
                 //print all the seeds to std::cout
                 void printSeeds();
+                //align the read to the graph, adding the local alignments
+                //to ar
+                void alignSeeds(AlignedRead &ar);
                 //chain seeds
                 void chainSeeds(AlignedRead &ar,
                         std::vector<std::string> &corrections);
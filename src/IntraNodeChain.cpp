@@ -25,10 +25,12 @@
 #include <iostream>
 
 #include "Settings.hpp"
+#include "CorrectionContext.hpp"
 
 IntraNodeChain::IntraNodeChain(std::vector<Seed> &seeds,
-        Settings const &settings)
+        Settings const &settings, CorrectionContext &context)
  :        settings_(settings),
+        context_(context),
         seeds_(seeds),
         maximal_coverage_(0),
         min_cov_coef_(.15)
@@ -52,72 +54,90 @@ bool IntraNodeChain::checkFit(int const &ref_dist, int const &read_dist) {
                 && read_dist < ref_dist * 1.2 + 20);
 }
 
-void IntraNodeChain::fitAndExtend(
-                std::vector<std::vector<Seed>> &consecutive_seeds, 
-                std::vector<int> &chain_coverage, Seed const &seed) {
-        bool extends = false;
-        for (int j = 0; j < consecutive_seeds.size(); ++j) {
-                std::vector<Seed> chain = consecutive_seeds[j];
-                int k = 0;
-                //find the location in the chain where we can insert this seed
-                while (k < chain.size()
-                        && seed.get_read_start() > chain[k].get_read_start())
+void IntraNodeChain::chainSeeds(std::vector<InexactSeed> &chains) {
+        //order the seeds along the read, a seed can only follow earlier ones
+        auto compare_seed_start = [&](Seed const &a, Seed const &b)-> bool {
+                if (a.get_read_start() != b.get_read_start()) {
+                        return a.get_read_start() < b.get_read_start();
+                }
+                return a.get_ref_start() < b.get_ref_start();
+        };
+        std::sort(seeds_.begin(), seeds_.end(), compare_seed_start);
+        //best coverage of a chain ending in each seed; checkFit allows a
+        //gap in the read of at most 1.2 times the gap in the node plus 20,
+        //and the gap in the node is smaller than the start of the seed, so
+        //only the seeds that end within that reach of its start can precede
+        //it and the search stops at the first seed that cannot
+        int n = seeds_.size();
+        int max_length = 0;
+        for (int i = 0; i < n; ++i) {
+                max_length = std::max(max_length, seeds_[i].get_length());
+        }
+        std::vector<int> &coverage = context_.coverage;
+        std::vector<int> &predecessor = context_.predecessor;
+        coverage.resize(n);
+        predecessor.assign(n, -1);
+        for (int i = 0; i < n; ++i) {
+                int length = seeds_[i].get_length();
+                int read_start = seeds_[i].get_read_start();
+                double reach = 1.2 * seeds_[i].get_ref_start() + 20;
+                int first = i;
+                while (first > 0 && read_start - (seeds_[first - 1].get_read_start()
+                        + max_length) < reach)
                 {
-                        ++k;
+                        --first;
                 }
-                //check if the Seed fits
-                bool fits = true;
-                if (0 < k) {
-                        Seed prev = chain[k - 1];
-                        fits = fits && checkFit(prev, seed);
+                coverage[i] = length;
+                for (int j = first; j < i; ++j) {
+                        if (coverage[j] + length > coverage[i]
+                                && checkFit(seeds_[j], seeds_[i]))
+                        {
+                                coverage[i] = coverage[j] + length;
+                                predecessor[i] = j;
+                        }
                 }
-                if (fits && k < chain.size()) {
-                        Seed next = chain[k];
-                        fits = fits && checkFit(seed, next);
+        }
+        //extract the chains from the highest coverage down, a chain stops
+        //at a seed taken by an earlier chain
+        std::vector<int> &order = context_.order;
+        order.resize(n);
+        for (int i = 0; i < n; ++i) {
+                order[i] = i;
+        }
+        std::sort(order.begin(), order.end(), [&](int a, int b)-> bool {
+                return coverage[a] > coverage[b]
+                        || (coverage[a] == coverage[b] && a < b);
+        });
+        std::vector<bool> &used = context_.used;
+        used.assign(n, false);
+        for (int i = 0; i < n; ++i) {
+                int front = -1;
+                int chain_coverage = 0;
+                for (int j = order[i]; j >= 0 && !used[j]; j = predecessor[j]) {
+                        used[j] = true;
+                        front = j;
+                        chain_coverage += seeds_[j].get_length();
                 }
-                if (fits) {
-                        //if the Seed fits, place it
-                        chain.insert(chain.begin() + k, seed);
-                        consecutive_seeds[j] = chain;
-                        chain_coverage[j] += seed.get_length();
-                        maximal_coverage_ = maximal_coverage_ > chain_coverage[j]
-                                ? maximal_coverage_ : chain_coverage[j];
-                        extends = true;
+                //keep the chain if it is sufficiently large
+                if (front >= 0 && chain_coverage > maximal_coverage_ / 5) {
+                        chains.push_back(InexactSeed(seeds_[front],
+                                seeds_[order[i]]));
+                        maximal_coverage_ = maximal_coverage_ > chain_coverage
+                                ? maximal_coverage_ : chain_coverage;
                 }
         }
-        //add new chain if seed doesn't extend any chain and is sufficiently large
-        if (!extends
-                && ((int unsigned) seed.get_length() > maximal_coverage_ / 5))
-        {
-                std::vector<Seed> chain;
-                chain.push_back(seed);
-                consecutive_seeds.push_back(chain);
-                chain_coverage.push_back(seed.get_length());
-                maximal_coverage_ = maximal_coverage_ > seed.get_length()
-                        ? maximal_coverage_ : seed.get_length();
-        }
 }
 
 void IntraNodeChain::groupSeedsInNode(std::vector<InexactSeed> &inexact_seeds) {
-        std::vector<std::vector<Seed>> consecutive_seeds;
-        std::vector<int> chain_coverage;
-        //sort seeds from largest to smallest
-        auto compare_seed_size = [&](Seed a, Seed b)-> bool {
-                return a.get_length() > b.get_length();
-        };
-        std::sort(seeds_.begin(), seeds_.end(), compare_seed_size);
-        //loop through all seeds and check if they fit
-        for (int i = 0; i < seeds_.size(); ++i) {
-                fitAndExtend(consecutive_seeds, chain_coverage, seeds_[i]);
-        }
+        std::vector<InexactSeed> &chains = context_.chains;
+        chains.clear();
+        chainSeeds(chains);
         double mcc = min_cov_coef_;
-        while (inexact_seeds.size() == 0 && consecutive_seeds.size() > 0) {
-                for (int i = 0; i < consecutive_seeds.size(); ++i) {
-                        int req_cov = (consecutive_seeds[i].back().get_ref_end()
-                                - consecutive_seeds[i][0].get_ref_start())
-                                * mcc;
-                        InexactSeed is(consecutive_seeds[i]);
-                        inexact_seeds.push_back(is);
+        while (inexact_seeds.size() == 0 && chains.size() > 0) {
+                for (int i = 0; i < chains.size(); ++i) {
+                        int req_cov = (chains[i].get_node_end()
+                                - chains[i].get_node_start()) * mcc;
+                        inexact_seeds.push_back(chains[i]);
                 }
                 mcc *= 0.9;
         }
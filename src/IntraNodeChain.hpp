@@ -21,15 +21,18 @@
 #define INTRANODECHAIN_HPP
 
 #include <string>
+#include <vector>
 
 #include "InexactSeed.hpp"
 
 class Read;
 class Settings;
+struct CorrectionContext;
 
 class IntraNodeChain{
         private:
                 Settings const &settings_; //reference to settings
+                CorrectionContext &context_; //buffers of the worker
                 std::vector<Seed> &seeds_; //reference to seeds
                 int maximal_coverage_; //current highest coverage of node by a chain
                 double min_cov_coef_; //used to determine required exact coverage
@@ -39,15 +42,15 @@ class IntraNodeChain{
                 //check if seed fits
                 bool checkFit(Seed const &prev, Seed const &next);
                 bool checkFit(int const &ref_dist, int const &read_dist);
-                //try to fit all seeds and extend a chain
-                void fitAndExtend(std::vector<std::vector<Seed>> &consecutive_seeds,
-                        std::vector<int> &chain_coverage, Seed const &seed);
+                //chain the seeds with a colinear chaining DP and extract the
+                //chains in order of decreasing coverage
+                void chainSeeds(std::vector<InexactSeed> &chains);
         public:
                 /*
                  *        ctors
                  */
                 IntraNodeChain(std::vector<Seed> &seeds,
-                        Settings const &settings);
+                        Settings const &settings, CorrectionContext &context);
                 /*
                  *        methods
                  */
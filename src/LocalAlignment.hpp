@@ -22,14 +22,25 @@
 
 #include <vector>
 #include <string>
+#include <utility>
+
+#include "PathArena.hpp"
 
 class LocalAlignment {
         int read_start_; //start of read
         int read_end_; //end of read
         int ref_start_; //start of ref
         int ref_end_; //end of ref
-        std::vector<int> path_; //list of nodes
+        PathArena *paths_; //arena holding the path
+        int path_start_; //start of the path in the arena
+        int path_size_; //number of nodes on the path
 public:
+        /*
+         *        ctors
+         */
+        LocalAlignment()
+              :        read_start_(0), read_end_(0), ref_start_(0), ref_end_(0),
+                paths_(NULL), path_start_(0), path_size_(0) {}
         /*
          *        methods
          */
@@ -38,13 +49,34 @@ public:
         int get_read_end() const {return read_end_;}
         int get_ref_start() const {return ref_start_;}
         int get_ref_end() const {return ref_end_;}
-        std::vector<int> get_path() const {return path_;}
+        NodePath get_path() const {
+                if (paths_ == NULL) {
+                        return NodePath();
+                }
+                return paths_->get(path_start_, path_size_);
+        }
         //setters
         void set_read_start(int read_start) {read_start_ = read_start;}
         void set_read_end(int read_end) {read_end_ = read_end;}
         void set_ref_start(int ref_start) {ref_start_ = ref_start;}
         void set_ref_end(int ref_end) {ref_end_ = ref_end;}
-        void set_path(std::vector<int> path) {path_ = path;}
+        //the path of size nodes at start in paths
+        void set_path(PathArena &paths, int start, int size) {
+                paths_ = &paths;
+                path_start_ = start;
+                path_size_ = size;
+        }
+        //store a copy of path in paths
+        void set_path(PathArena &paths, NodePath path) {
+                int start = paths.size();
+                paths.append(path);
+                set_path(paths, start, path.size());
+        }
+        //append nodes to the path
+        void extend_path(NodePath nodes) {
+                path_start_ = paths_->extend(path_start_, path_size_, nodes);
+                path_size_ += nodes.size();
+        }
         
         std::string to_string(int read_id) const {
                 std::string str = "Read " + std::to_string(read_id)
@@ -52,7 +84,7 @@ public:
                         + ", " + std::to_string(read_end_) + "] "
                         + " Ref: [" + std::to_string(ref_start_)
                         + ", " + std::to_string(ref_end_) + "] ";
-                for (auto n : path_) {
+                for (auto n : get_path()) {
                         str += std::to_string(n) + " ";
                 }
                 return str;
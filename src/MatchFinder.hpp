@@ -0,0 +1,99 @@
+/*******************************************************************************
+ *   Copyright (C) 2014, 2015 Giles Miclotte (giles.miclotte@intec.ugent.be)   *
+ *   This file is part of Jabba                                                *
+ *                                                                             *
+ *   This program is free software; you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published by      *
+ *   the Free Software Foundation; either version 2 of the License, or         *
+ *   (at your option) any later version.                                       *
+ *                                                                             *
+ *   This program is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *   GNU General Public License for more details.                              *
+ *                                                                             *
+ *   You should have received a copy of the GNU General Public License         *
+ *   along with this program; if not, write to the                             *
+ *   Free Software Foundation, Inc.,                                           *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.                 *
+ *******************************************************************************/
+#ifndef MATCHFINDER_HPP
+#define MATCHFINDER_HPP
+
+#include <vector>
+#include <string>
+
+#include "mummer/sparseSA.hpp"
+
+// ============================================================================
+// MATCH FINDER CLASS
+// ============================================================================
+
+//finds exact matches between reads and the concatenated node sequences,
+//SeedFinder turns them into seeds
+class MatchFinder {
+        public:
+                /*
+                 *        dtors
+                 */
+                virtual ~MatchFinder() {}
+                /*
+                 *        methods
+                 */
+                //report the matches of at least min_len between read and
+                //reference to the visitor; if skip is not NULL, no matches
+                //starting at the read positions marked in it are searched
+                virtual void findMatches(std::string const &read,
+                        std::vector<bool> const *skip, mem_visitor_t &visitor,
+                        int const min_len) const = 0;
+                //report the matches of many reads, reads[i] to visitors[i]
+                virtual void findMatches(
+                        std::vector<std::string const *> const &reads,
+                        std::vector<std::vector<bool> const *> const &skips,
+                        std::vector<mem_visitor_t *> const &visitors,
+                        int const min_len) const
+                {
+                        for (size_t i = 0; i < reads.size(); ++i) {
+                                findMatches(*reads[i], skips[i], *visitors[i],
+                                        min_len);
+                        }
+                }
+                //size of the index
+                virtual long size_in_bytes() const = 0;
+};
+
+// ============================================================================
+// ESSA MATCH FINDER CLASS
+// ============================================================================
+
+//maximal exact matches from the enhanced sparse suffix array
+class EssaMatchFinder : public MatchFinder {
+        private:
+                sparseSA const &sa_; //the suffix array, owned by SeedFinder
+        public:
+                /*
+                 *        ctors
+                 */
+                EssaMatchFinder(sparseSA const &sa) : sa_(sa) {}
+                /*
+                 *        methods
+                 */
+                void findMatches(std::string const &read,
+                        std::vector<bool> const *skip, mem_visitor_t &visitor,
+                        int const min_len) const
+                {
+                        sa_.findMEM(0, read, visitor, min_len, skip);
+                }
+                void findMatches(std::vector<std::string const *> const &reads,
+                        std::vector<std::vector<bool> const *> const &skips,
+                        std::vector<mem_visitor_t *> const &visitors,
+                        int const min_len) const
+                {
+                        sa_.findMEMBatch(reads, skips, visitors, min_len);
+                }
+                long size_in_bytes() const {
+                        return sa_.index_size_in_bytes();
+                }
+};
+
+#endif
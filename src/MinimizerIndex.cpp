@@ -0,0 +1,185 @@
+/*******************************************************************************
+ *   Copyright (C) 2014, 2015 Giles Miclotte (giles.miclotte@intec.ugent.be)   *
+ *   This file is part of Jabba                                                *
+ *                                                                             *
+ *   This program is free software; you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published by      *
+ *   the Free Software Foundation; either version 2 of the License, or         *
+ *   (at your option) any later version.                                       *
+ *                                                                             *
+ *   This program is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *   GNU General Public License for more details.                              *
+ *                                                                             *
+ *   You should have received a copy of the GNU General Public License         *
+ *   along with this program; if not, write to the                             *
+ *   Free Software Foundation, Inc.,                                           *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.                 *
+ *******************************************************************************/
+#include "MinimizerIndex.hpp"
+
+#include <deque>
+#include <thread>
+#include <algorithm>
+#include <unordered_map>
+
+//2-bit code of a nucleotide, 4 for anything else
+static inline int nucleotideCode(char c) {
+        switch (c) {
+                case 'A': return 0;
+                case 'C': return 1;
+                case 'G': return 2;
+                case 'T': return 3;
+                default: return 4;
+        }
+}
+
+//invertible integer hash, so that equal hashes mean equal k-mers and
+//minimizers are not biased towards low complexity k-mers
+static inline uint32_t hashCode(uint64_t key, uint64_t mask) {
+        key = (~key + (key << 21)) & mask;
+        key = key ^ key >> 24;
+        key = ((key + (key << 3)) + (key << 8)) & mask;
+        key = key ^ key >> 14;
+        key = ((key + (key << 2)) + (key << 4)) & mask;
+        key = key ^ key >> 28;
+        key = (key + (key << 31)) & mask;
+        return (uint32_t)key;
+}
+
+MinimizerIndex::MinimizerIndex(std::string const &reference, int k, int w,
+        int num_threads, long max_occ)
+      :        reference_(reference), k_(k), w_(w), max_occ_(max_occ)
+{
+        //every thread collects and sorts the minimizers of a slice
+        long size = reference_.size();
+        num_threads = std::max(1, num_threads);
+        std::vector<std::vector<Minimizer> > parts(num_threads);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < num_threads; ++t) {
+                long begin = size * t / num_threads;
+                long end = size * (t + 1) / num_threads;
+                threads.push_back(std::thread([this, &parts, t, begin, end]() {
+                        getMinimizers(reference_, begin, end, k_, w_, parts[t]);
+                        std::sort(parts[t].begin(), parts[t].end());
+                }));
+        }
+        for (auto &thread : threads) {
+                thread.join();
+        }
+        std::vector<Minimizer> minimizers;
+        for (auto &part : parts) {
+                long middle = minimizers.size();
+                minimizers.insert(minimizers.end(), part.begin(), part.end());
+                std::vector<Minimizer>().swap(part);
+                std::inplace_merge(minimizers.begin(),
+                        minimizers.begin() + middle, minimizers.end());
+        }
+        //windows around the slice borders may be reported twice
+        minimizers.erase(std::unique(minimizers.begin(), minimizers.end()),
+                minimizers.end());
+        hashes_.reserve(minimizers.size());
+        positions_.reserve(minimizers.size());
+        for (auto const &m : minimizers) {
+                hashes_.push_back(m.hash);
+                positions_.push_back(m.pos);
+        }
+}
+
+void MinimizerIndex::getMinimizers(std::string const &seq, long begin,
+        long end, int k, int w, std::vector<Minimizer> &minimizers)
+{
+        uint64_t mask = (1ULL << (2 * k)) - 1;
+        //start early enough to fill the window of the first k-mer
+        long first = std::max(0L, begin - w + 1);
+        long last = std::min((long)seq.size(), end + k - 1);
+        std::deque<Minimizer> window; //increasing hashes, candidates for the minimum
+        uint64_t code = 0;
+        int valid = 0; //number of consecutive nucleotides
+        long reported = -1;
+        for (long p = first; p < last; ++p) {
+                int c = nucleotideCode(seq[p]);
+                if (c > 3) {
+                        //k-mers do not span other characters, such as the
+                        //separators between nodes
+                        valid = 0;
+                        window.clear();
+                        continue;
+                }
+                code = ((code << 2) | c) & mask;
+                if (++valid < k) {
+                        continue;
+                }
+                Minimizer m = {hashCode(code, mask), p - k + 1};
+                while (!window.empty() && m.hash < window.back().hash) {
+                        window.pop_back();
+                }
+                window.push_back(m);
+                while (window.front().pos <= m.pos - w) {
+                        window.pop_front();
+                }
+                if (valid >= k + w - 1 && m.pos >= begin
+                        && window.front().pos != reported)
+                {
+                        reported = window.front().pos;
+                        minimizers.push_back(window.front());
+                }
+        }
+}
+
+void MinimizerIndex::findMatches(std::string const &read,
+        std::vector<bool> const *skip, mem_visitor_t &visitor,
+        int const min_len) const
+{
+        std::vector<Minimizer> minimizers;
+        getMinimizers(read, 0, read.size(), k_, w_, minimizers);
+        //end in the read of the last match per diagonal, anchors are found
+        //left to right so an anchor inside that match gives the same match
+        std::unordered_map<long, long> diagonal_end;
+        long read_size = read.size();
+        long ref_size = reference_.size();
+        for (auto const &m : minimizers) {
+                //anchors in skipped positions are not extended
+                if (skip != NULL && (*skip)[m.pos]) {
+                        continue;
+                }
+                auto first = std::lower_bound(hashes_.begin(), hashes_.end(), m.hash);
+                auto last = std::upper_bound(first, hashes_.end(), m.hash);
+                if (max_occ_ > 0 && last - first > max_occ_) {
+                        continue;
+                }
+                for (auto it = first; it != last; ++it) {
+                        long ref = positions_[it - hashes_.begin()];
+                        long query = m.pos;
+                        long diagonal = ref - query;
+                        auto d = diagonal_end.find(diagonal);
+                        if (d != diagonal_end.end() && query < d->second) {
+                                continue;
+                        }
+                        //the hash is invertible, so the k-mers are equal
+                        long left = 0;
+                        while (query - left > 0 && ref - left > 0
+                                && read[query - left - 1] == reference_[ref - left - 1])
+                        {
+                                ++left;
+                        }
+                        long right = k_;
+                        while (query + right < read_size && ref + right < ref_size
+                                && read[query + right] == reference_[ref + right])
+                        {
+                                ++right;
+                        }
+                        diagonal_end[diagonal] = query + right;
+                        if (left + right >= min_len) {
+                                visitor.visit(match_t(ref - left, query - left, left + right,
+                                        last - first));
+                        }
+                }
+        }
+}
+
+long MinimizerIndex::size_in_bytes() const {
+        return hashes_.capacity() * sizeof(uint32_t)
+                + positions_.capacity() * sizeof(long);
+}
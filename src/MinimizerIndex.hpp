@@ -0,0 +1,77 @@
+/*******************************************************************************
+ *   Copyright (C) 2014, 2015 Giles Miclotte (giles.miclotte@intec.ugent.be)   *
+ *   This file is part of Jabba                                                *
+ *                                                                             *
+ *   This program is free software; you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published by      *
+ *   the Free Software Foundation; either version 2 of the License, or         *
+ *   (at your option) any later version.                                       *
+ *                                                                             *
+ *   This program is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *   GNU General Public License for more details.                              *
+ *                                                                             *
+ *   You should have received a copy of the GNU General Public License         *
+ *   along with this program; if not, write to the                             *
+ *   Free Software Foundation, Inc.,                                           *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.                 *
+ *******************************************************************************/
+#ifndef MINIMIZERINDEX_HPP
+#define MINIMIZERINDEX_HPP
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+#include "MatchFinder.hpp"
+
+// ============================================================================
+// MINIMIZER INDEX CLASS
+// ============================================================================
+
+//(w,k) minimizer of a sequence: hash of the k-mer and its position
+struct Minimizer {
+        uint32_t hash; //invertible hash of the 2-bit encoded k-mer
+        long pos; //start of the k-mer in the sequence
+        bool operator<(Minimizer const &other) const {
+                return hash < other.hash || (hash == other.hash && pos < other.pos);
+        }
+        bool operator==(Minimizer const &other) const {
+                return hash == other.hash && pos == other.pos;
+        }
+};
+
+//index of the (w,k) minimizers of the reference; a read minimizer that
+//also occurs in the reference is an anchor, which is extended in both
+//directions to a maximal exact match
+class MinimizerIndex : public MatchFinder {
+        private:
+                std::string const &reference_; //concatenated node sequences
+                int k_; //k-mer size, at most 16
+                int w_; //number of consecutive k-mers in a window
+                long max_occ_; //skip minimizers occurring more often, 0 = never
+                std::vector<uint32_t> hashes_; //sorted minimizer hashes
+                std::vector<long> positions_; //reference position per hash
+        public:
+                /*
+                 *        ctors
+                 */
+                //every exact match of at least w + k - 1 contains a minimizer
+                MinimizerIndex(std::string const &reference, int k, int w,
+                        int num_threads, long max_occ);
+                /*
+                 *        methods
+                 */
+                //compute the minimizers of the windows that end with the
+                //k-mer starting in [begin, end) and add them to minimizers
+                static void getMinimizers(std::string const &seq, long begin,
+                        long end, int k, int w,
+                        std::vector<Minimizer> &minimizers);
+                void findMatches(std::string const &read,
+                        std::vector<bool> const *skip, mem_visitor_t &visitor,
+                        int const min_len) const;
+                long size_in_bytes() const;
+};
+
+#endif
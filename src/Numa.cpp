@@ -0,0 +1,146 @@
+/*******************************************************************************
+ *   Copyright (C) 2014, 2015 Giles Miclotte (giles.miclotte@intec.ugent.be)   *
+ *   This file is part of Jabba                                                *
+ *                                                                             *
+ *   This program is free software; you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published by      *
+ *   the Free Software Foundation; either version 2 of the License, or         *
+ *   (at your option) any later version.                                       *
+ *                                                                             *
+ *   This program is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *   GNU General Public License for more details.                              *
+ *                                                                             *
+ *   You should have received a copy of the GNU General Public License         *
+ *   along with this program; if not, write to the                             *
+ *   Free Software Foundation, Inc.,                                           *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.                 *
+ *******************************************************************************/
+#include "Numa.hpp"
+
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <mutex>
+
+#ifdef __linux__
+        #include <pthread.h>
+        #include <sched.h>
+        #include <unistd.h>
+        #include <sys/syscall.h>
+#endif
+
+//values from linux/mempolicy.h, which is not always installed
+#ifndef MPOL_INTERLEAVE
+        #define MPOL_INTERLEAVE 3
+#endif
+#ifndef MPOL_MF_MOVE
+        #define MPOL_MF_MOVE (1 << 1)
+#endif
+
+std::vector<std::vector<int> > Numa::nodes_;
+
+namespace {
+        std::once_flag init_flag;
+
+        //parse a cpulist such as "0-3,8-11"
+        std::vector<int> parseCPUList(std::string const &list) {
+                std::vector<int> cpus;
+                std::istringstream iss(list);
+                std::string range;
+                while (std::getline(iss, range, ',')) {
+                        if (range.empty())
+                                continue;
+                        size_t dash = range.find('-');
+                        int first = std::stoi(range.substr(0, dash));
+                        int last = dash == std::string::npos
+                                ? first : std::stoi(range.substr(dash + 1));
+                        for (int cpu = first; cpu <= last; ++cpu)
+                                cpus.push_back(cpu);
+                }
+                return cpus;
+        }
+}
+
+void Numa::init()
+{
+        for (int node = 0; ; ++node) {
+                std::ifstream file("/sys/devices/system/node/node"
+                        + std::to_string(node) + "/cpulist");
+                if (!file.good())
+                        break;
+                std::string list;
+                std::getline(file, list);
+                nodes_.push_back(parseCPUList(list));
+        }
+        if (nodes_.empty()) {
+                std::vector<int> cpus;
+                for (unsigned int cpu = 0; cpu < std::thread::hardware_concurrency(); ++cpu)
+                        cpus.push_back(cpu);
+                nodes_.push_back(cpus);
+        }
+}
+
+int Numa::get_num_nodes()
+{
+        std::call_once(init_flag, &Numa::init);
+        return nodes_.size();
+}
+
+std::vector<int> const &Numa::get_cpus(int node)
+{
+        std::call_once(init_flag, &Numa::init);
+        return nodes_[node];
+}
+
+int Numa::get_worker_cpu(size_t thread_id)
+{
+        int num_nodes = get_num_nodes();
+        //memory-only nodes have no CPUs, skip those
+        for (int i = 0; i < num_nodes; ++i) {
+                std::vector<int> const &cpus
+                        = get_cpus((thread_id + i) % num_nodes);
+                if (!cpus.empty())
+                        return cpus[(thread_id / num_nodes) % cpus.size()];
+        }
+        return -1;
+}
+
+bool Numa::pin(std::thread &thread, int cpu)
+{
+#ifdef __linux__
+        if (cpu < 0 || !thread.joinable())
+                return false;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        return pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) == 0;
+#else
+        return false;
+#endif
+}
+
+bool Numa::interleave(void const *ptr, size_t bytes)
+{
+        int num_nodes = get_num_nodes();
+        if (num_nodes < 2)
+                return false;
+#if defined(__linux__) && defined(SYS_mbind)
+        //only whole pages inside the buffer can be placed
+        uintptr_t page = sysconf(_SC_PAGESIZE);
+        uintptr_t start = ((uintptr_t)ptr + page - 1) / page * page;
+        uintptr_t end = ((uintptr_t)ptr + bytes) / page * page;
+        if (end <= start)
+                return false;
+        size_t bits = 8 * sizeof(unsigned long);
+        std::vector<unsigned long> mask((num_nodes + bits - 1) / bits, 0);
+        for (int node = 0; node < num_nodes; ++node)
+                mask[node / bits] |= 1UL << (node % bits);
+        return syscall(SYS_mbind, start, end - start, MPOL_INTERLEAVE,
+                &mask[0], mask.size() * bits + 1, MPOL_MF_MOVE) == 0;
+#else
+        return false;
+#endif
+}
@@ -0,0 +1,85 @@
+/*******************************************************************************
+ *   Copyright (C) 2014, 2015 Giles Miclotte (giles.miclotte@intec.ugent.be)   *
+ *   This file is part of Jabba                                                *
+ *                                                                             *
+ *   This program is free software; you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published by      *
+ *   the Free Software Foundation; either version 2 of the License, or         *
+ *   (at your option) any later version.                                       *
+ *                                                                             *
+ *   This program is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *   GNU General Public License for more details.                              *
+ *                                                                             *
+ *   You should have received a copy of the GNU General Public License         *
+ *   along with this program; if not, write to the                             *
+ *   Free Software Foundation, Inc.,                                           *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.                 *
+ *******************************************************************************/
+#ifndef NUMA_HPP
+#define NUMA_HPP
+
+#include <vector>
+#include <thread>
+#include <cstddef>
+
+// ============================================================================
+// NUMA CLASS
+// ============================================================================
+
+/**
+ * NUMA topology, memory placement and thread affinity. Without NUMA support
+ * the machine is treated as a single node and all calls are harmless.
+ */
+class Numa
+{
+private:
+        static std::vector<std::vector<int> > nodes_; //CPUs of every node
+
+        /**
+         * Read the topology from /sys/devices/system/node
+         */
+        static void init();
+
+public:
+        /**
+         * Get the number of NUMA nodes
+         * @return The number of NUMA nodes, at least one
+         */
+        static int get_num_nodes();
+
+        /**
+         * Get the CPUs of a NUMA node
+         * @param node Node identifier
+         * @return List of CPU identifiers
+         */
+        static std::vector<int> const &get_cpus(int node);
+
+        /**
+         * Get the CPU a worker thread should run on, spreading consecutive
+         * threads over the nodes
+         * @param thread_id Identifier of the worker thread
+         * @return A CPU identifier
+         */
+        static int get_worker_cpu(size_t thread_id);
+
+        /**
+         * Pin a thread to a CPU
+         * @param thread Thread to pin
+         * @param cpu CPU identifier
+         * @return True if the affinity was set
+         */
+        static bool pin(std::thread &thread, int cpu);
+
+        /**
+         * Spread the pages of a buffer round-robin over all nodes, moving
+         * pages that are already populated
+         * @param ptr Start of the buffer
+         * @param bytes Size of the buffer
+         * @return True if the memory policy was applied
+         */
+        static bool interleave(void const *ptr, size_t bytes);
+};
+
+#endif
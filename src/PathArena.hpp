@@ -0,0 +1,105 @@
+/*******************************************************************************
+ *   Copyright (C) 2014, 2015 Giles Miclotte (giles.miclotte@intec.ugent.be)   *
+ *   This file is part of Jabba                                                *
+ *                                                                             *
+ *   This program is free software; you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published by      *
+ *   the Free Software Foundation; either version 2 of the License, or         *
+ *   (at your option) any later version.                                       *
+ *                                                                             *
+ *   This program is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *   GNU General Public License for more details.                              *
+ *                                                                             *
+ *   You should have received a copy of the GNU General Public License         *
+ *   along with this program; if not, write to the                             *
+ *   Free Software Foundation, Inc.,                                           *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.                 *
+ *******************************************************************************/
+#ifndef PATHARENA_HPP
+#define PATHARENA_HPP
+
+#include <vector>
+#include <algorithm>
+#include <functional>
+
+//nodes of a path, a view on storage owned elsewhere; it is valid until that
+//storage grows
+class NodePath {
+        int const *begin_; //first node
+        int const *end_; //one past the last node
+public:
+        NodePath() : begin_(NULL), end_(NULL) {}
+        NodePath(int const *begin, int const *end) : begin_(begin), end_(end) {}
+        NodePath(std::vector<int> const &path)
+              :        begin_(path.data()), end_(path.data() + path.size()) {}
+        int const *begin() const {return begin_;}
+        int const *end() const {return end_;}
+        int size() const {return end_ - begin_;}
+        bool empty() const {return begin_ == end_;}
+        int operator[](int i) const {return begin_[i];}
+        int front() const {return *begin_;}
+        int back() const {return *(end_ - 1);}
+};
+
+//paths of the local alignments of a read, stored back to back; the storage
+//is kept when the arena is cleared, so the paths of a read are built without
+//allocating once the arena has grown
+class PathArena {
+        std::vector<int> nodes_; //nodes of all paths
+        //position of nodes in the arena, -1 if they are stored elsewhere
+        int find(NodePath nodes) const {
+                std::less<int const *> less;
+                int const *data = nodes_.data();
+                if (nodes.empty() || less(nodes.begin(), data)
+                        || !less(nodes.begin(), data + nodes_.size()))
+                {
+                        return -1;
+                }
+                return nodes.begin() - data;
+        }
+public:
+        int size() const {return nodes_.size();}
+        NodePath get(int start, int size) const {
+                return NodePath(nodes_.data() + start,
+                        nodes_.data() + start + size);
+        }
+        //append nodes, which may be stored in the arena itself
+        void append(NodePath nodes) {
+                int start = find(nodes);
+                if (start < 0) {
+                        nodes_.insert(nodes_.end(), nodes.begin(), nodes.end());
+                        return;
+                }
+                int end = nodes_.size();
+                nodes_.resize(end + nodes.size());
+                std::copy(nodes_.begin() + start,
+                        nodes_.begin() + start + (nodes_.size() - end),
+                        nodes_.begin() + end);
+        }
+        void push_back(int node) {nodes_.push_back(node);}
+        //append nodes to the path of size nodes at start, the path is moved
+        //to the end of the arena unless it already ends there; returns the
+        //new start of the path
+        int extend(int start, int size, NodePath nodes) {
+                if (start + size == nodes_.size()) {
+                        append(nodes);
+                        return start;
+                }
+                //the nodes may move when the path is copied
+                int offset = find(nodes);
+                int count = nodes.size();
+                int new_start = nodes_.size();
+                append(get(start, size));
+                if (offset < 0) {
+                        append(nodes);
+                } else {
+                        append(get(offset, count));
+                }
+                return new_start;
+        }
+        void clear() {nodes_.clear();}
+};
+
+#endif
@@ -20,13 +20,18 @@
 #ifndef READ_HPP
 #define READ_HPP
 
-#include "TString.hpp"
+#include <vector>
+#include <string>
+#include <algorithm>
 
+//a read does not own its data, it refers to the strings of the read record
+//it was made from, which have to outlive it
 class Read {
 private:
         int id_;                //ID of the read
-        TString sequence_;        //DNA sequence of the read
-        std::string meta_;        //meta data
+        std::string const *sequence_;        //DNA sequence of the read
+        std::string const *meta_;        //meta data
+        char const *quality_;        //Phred+33 quality scores, NULL if unknown
         
 public:
         /*
@@ -34,31 +39,50 @@ public:
          */
         Read(std::string const &meta, std::string const &sequence)
               :        id_(-1),
-                sequence_(sequence),
-                meta_(meta)
+                sequence_(&sequence),
+                meta_(&meta),
+                quality_(NULL)
         {}
-        Read(Read const &read)
-              :        id_(read.get_id()),
-                sequence_(read.get_sequence()),
-                meta_(read.get_meta())
-        {}
-        Read(int const &id, std::string const &meta, std::string const &sequence)
+        Read(int const &id, std::string const &meta, std::string const &sequence,
+                char const *quality = NULL)
               :        id_(id),
-                sequence_(sequence),
-                meta_(meta)
+                sequence_(&sequence),
+                meta_(&meta),
+                quality_(quality)
         {}
-        ~Read() {}
         /*
          *        methods
          */
         //getters
-        int size() const {return sequence_.getLength();}
+        int size() const {return sequence_->size();}
         int get_id() const {return id_;}
-        std::string get_meta() const {return meta_;}
-        std::string get_sequence() const {return sequence_.getSequence();}
+        std::string const &get_meta() const {return *meta_;}
+        std::string const &get_sequence() const {return *sequence_;}
+        //size() scores, NULL if unknown
+        char const *get_quality() const {return quality_;}
+        //mark the positions where the window of the given size that starts
+        //there has a mean quality below min_quality, nothing is marked for
+        //reads without quality scores
+        void getLowQualityMask(int min_quality, int window,
+                std::vector<bool> &mask) const
+        {
+                mask.assign(size(), false);
+                if (quality_ == NULL || window <= 0) {
+                        return;
+                }
+                int n = size();
+                long sum = 0;
+                for (int i = n - 1; i >= 0; --i) {
+                        sum += quality_[i] - 33;
+                        if (i + window < n) {
+                                sum -= quality_[i + window] - 33;
+                        }
+                        int len = std::min(window, n - i);
+                        mask[i] = sum < (long)min_quality * len;
+                }
+        }
         //setters
         void set_id(int id) {id_ = id;}
-        void set_meta(std::string meta) {meta_ = meta;}
 };
 
 #endif
@@ -1,23 +1,181 @@
 #include "ReadCorrectionHandler.hpp"
-#include "Alignment.hpp"
 #include "InterNodeChain.hpp"
 #include "Read.hpp"
 #include "AlignedRead.hpp"
+#include "LocalAlignment.hpp"
 #include "Seed.hpp"
+#include "Nucleotide.hpp"
+
+const int ReadCorrection::window_overlap_;
+
+/**
+ * Map a read onto the alphabet of the graph the way TString packs it:
+ * lowercase as uppercase and any other character as G
+ * @param sequence Sequence of the read
+ * @param buffer Storage for the mapped sequence
+ * @return The sequence itself if it is plain ACGT, the buffer otherwise
+ */
+static const string& normaliseSequence(const string& sequence, string& buffer)
+{
+        size_t i = 0;
+        while (i < sequence.size() && (sequence[i] == 'A' || sequence[i] == 'C' ||
+                                       sequence[i] == 'G' || sequence[i] == 'T'))
+                i++;
+        if (i == sequence.size())
+                return sequence;
+        buffer.assign(sequence);
+        for ( ; i < buffer.size(); i++)
+                buffer[i] = Nucleotide::nucleotideToChar(Nucleotide::charToNucleotide(buffer[i]));
+        return buffer;
+}
+
+void ReadCorrection::findSeeds(const Read& read, SeedTable& seeds)
+{
+        int min_len = settings_.get_stage_min_len(0);
+        std::vector<bool> skip;
+        if (settings_.get_min_quality() > 0)
+                read.getLowQualityMask(settings_.get_min_quality(), min_len, skip);
+        seeds.clear();
+        graph_.getSeeds(read.get_sequence(), skip.empty() ? NULL : &skip,
+                seeds, min_len);
+}
 
 void ReadCorrection::correctRead(ReadRecord& record)
 {
-        Read read(record.preRead, record.getRead());
-        read.set_id(0);
-        Alignment alignment(250, 30, 1, -4, -2, -3);
-        InterNodeChain iernc(read, graph_, settings_, alignment);
-        AlignedRead ar(read, settings_.get_output_mode());
+        if (sequences_.empty())
+                sequences_.resize(1);
+        Read read(0, record.preRead, normaliseSequence(record.read, sequences_[0]),
+                  record.getQuality());
+        findSeeds(read, context_.seeds);
+        correctRead(record, read, context_.seeds);
+}
+
+void ReadCorrection::correctRead(ReadRecord& record, Read& read,
+                                 SeedTable& seeds)
+{
+        InterNodeChain iernc(read, graph_, settings_, context_, seeds);
+        AlignedRead ar(read, settings_.get_output_mode(), context_);
         iernc.chainSeeds(ar, record.correction);
 }
 
+void ReadCorrection::alignWindow(Read& window, CorrectionContext& context,
+                                 vector<LocalAlignment>& alignments,
+                                 PathArena& paths)
+{
+        findSeeds(window, context.seeds);
+        InterNodeChain iernc(window, graph_, settings_, context, context.seeds);
+        AlignedRead ar(window, settings_.get_output_mode(), context);
+        iernc.alignSeeds(ar);
+        // the context is cleared for the next window, the paths move to
+        // the arena of this window
+        alignments = ar.get_local_alignments();
+        paths.clear();
+        for (LocalAlignment& la : alignments)
+                la.set_path(paths, la.get_path());
+}
+
+void ReadCorrection::correctLongRead(ReadRecord& record, Read& read)
+{
+        // windows of split_length bases, consecutive windows overlap
+        const string& sequence = read.get_sequence();
+        const char* quality = read.get_quality();
+        int size = sequence.size();
+        int length = settings_.get_split_length();
+        int overlap = min(window_overlap_, length / 2);
+        int step = length - overlap;
+        vector<int> starts;
+        for (int start = 0; ; start += step) {
+                // the last window ends at the end of the read
+                if (start + length >= size) {
+                        starts.push_back(max(size - length, 0));
+                        break;
+                }
+                starts.push_back(start);
+        }
+        vector<int> ends(starts.size());
+        for (size_t w = 0; w < starts.size(); w++)
+                ends[w] = min(starts[w] + length, size);
+
+        // the windows are shared with the helpers of the window pool
+        vector<vector<LocalAlignment> > alignments(starts.size());
+        vector<PathArena> paths(starts.size());
+        WindowPool::AlignFunction align = [&](size_t w, CorrectionContext& context) {
+                string windowSequence = sequence.substr(starts[w], ends[w] - starts[w]);
+                Read window(read.get_id(), read.get_meta(), windowSequence,
+                            quality == NULL ? NULL : quality + starts[w]);
+                alignWindow(window, context, alignments[w], paths[w]);
+        };
+        if (windowPool_ != NULL) {
+                windowPool_->alignWindows(starts.size(), align, context_);
+        } else {
+                for (size_t w = 0; w < starts.size(); w++)
+                        align(w, context_);
+        }
+
+        // an alignment in the overlap of two windows is kept by the window
+        // that owns its start, the boundary being the middle of the overlap;
+        // alignments that run past the end of the previous window are always
+        // kept, merging joins them with their truncated counterparts
+        AlignedRead ar(read, settings_.get_output_mode(), context_);
+        for (size_t w = 0; w < starts.size(); w++) {
+                int low = w > 0 ? (starts[w] + ends[w - 1]) / 2 : 0;
+                int high = w + 1 < starts.size() ? (starts[w + 1] + ends[w]) / 2 : size;
+                for (LocalAlignment& la : alignments[w]) {
+                        la.set_read_start(la.get_read_start() + starts[w]);
+                        la.set_read_end(la.get_read_end() + starts[w]);
+                        if (w > 0 && la.get_read_start() < low
+                            && la.get_read_end() <= ends[w - 1])
+                                continue;
+                        if (la.get_read_start() >= high)
+                                continue;
+                        ar.correct(la);
+                }
+        }
+        ar.getCorrectedRead(graph_, record.correction);
+}
+
 void ReadCorrection::correctChunk(vector<ReadRecord>& readChunk)
 {
-        for (auto& it : readChunk) {
-                correctRead(it);
+        // find the seeds of the whole chunk at once, the batched search
+        // overlaps the cache misses of the different reads; reads over the
+        // split length are seeded per window in correctLongRead
+        vector<Read> reads;
+        vector<bool> isLong(readChunk.size(), false);
+        reads.reserve(readChunk.size());
+        if (sequences_.size() < readChunk.size())
+                sequences_.resize(readChunk.size());
+        for (size_t i = 0; i < readChunk.size(); i++) {
+                ReadRecord& it = readChunk[i];
+                reads.push_back(Read(0, it.preRead,
+                                     normaliseSequence(it.read, sequences_[i]),
+                                     it.getQuality()));
+                isLong[i] = settings_.get_split_length() > 0 &&
+                            reads.back().size() > settings_.get_split_length();
+        }
+        if (seeds_.size() < readChunk.size())
+                seeds_.resize(readChunk.size());
+        // start positions in low quality windows are not searched
+        int min_len = settings_.get_stage_min_len(0);
+        vector<vector<bool> > masks(readChunk.size());
+        vector<const vector<bool>*> skips;
+        vector<const string*> queries;
+        vector<SeedTable*> chunkSeeds;
+        for (size_t i = 0; i < readChunk.size(); i++) {
+                seeds_[i].clear();
+                if (isLong[i])
+                        continue;
+                if (settings_.get_min_quality() > 0)
+                        reads[i].getLowQualityMask(settings_.get_min_quality(),
+                                                   min_len, masks[i]);
+                skips.push_back(masks[i].empty() ? NULL : &masks[i]);
+                queries.push_back(&reads[i].get_sequence());
+                chunkSeeds.push_back(&seeds_[i]);
+        }
+        graph_.getSeeds(queries, skips, chunkSeeds, min_len);
+        for (size_t i = 0; i < readChunk.size(); i++) {
+                if (isLong[i])
+                        correctLongRead(readChunk[i], reads[i]);
+                else
+                        correctRead(readChunk[i], reads[i], seeds_[i]);
         }
 }
@@ -1,8 +1,10 @@
 #include "ReadCorrectionHandler.hpp"
+#include "Numa.hpp"
 #include <functional>
-void ReadCorrectionHandler::workerThread(size_t myID, LibraryContainer& libraries)
+void ReadCorrectionHandler::workerThread(size_t myID, LibraryContainer& libraries,
+                                         WindowPool* windowPool)
 {
-        ReadCorrection readCorrection(graph_, settings_);
+        ReadCorrection readCorrection(graph_, settings_, windowPool);
         pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
         // local storage of reads
         std::vector<ReadRecord> myReadBuf;
@@ -26,14 +28,27 @@ void ReadCorrectionHandler::doErrorCorrection(LibraryContainer& libraries)
         libraries.startIOThreads(settings_.get_thread_work_size(),
                                  10 * settings_.get_thread_work_size() * settings_.get_num_threads(),
                                  true);
+        if (settings_.get_numa()) {
+                int lastNode = Numa::get_num_nodes() - 1;
+                libraries.pinIOThreads(Numa::get_worker_cpu(0),
+                                       Numa::get_worker_cpu(lastNode));
+        }
+        // split reads share one set of helper threads between the workers
+        WindowPool* windowPool = NULL;
+        if (settings_.get_split_length() > 0 && numThreads > 1)
+                windowPool = new WindowPool(numThreads - 1, settings_.get_numa());
         // start worker threads
         std::vector<std::thread> workerThreads(numThreads);
-        for (size_t i = 0; i < workerThreads.size(); i++)
+        for (size_t i = 0; i < workerThreads.size(); i++) {
                 workerThreads[i] = std::thread(&ReadCorrectionHandler::workerThread,
-                                          this, i, std::ref(libraries));
+                                          this, i, std::ref(libraries), windowPool);
+                if (settings_.get_numa())
+                        Numa::pin(workerThreads[i], Numa::get_worker_cpu(i));
+        }
         std::cout << "Worker threads started." << std::endl;
         // wait for worker threads to finish
         for_each(workerThreads.begin(), workerThreads.end(), std::mem_fn(&std::thread::join));
+        delete windowPool;
 
         libraries.joinIOThreads();
 }
@@ -24,6 +24,10 @@
 #include "library.h"
 #include "Graph.hpp"
 #include "util.h"
+#include "CorrectionContext.hpp"
+#include "WindowPool.hpp"
+
+class Read;
 // ============================================================================
 // READ CORRECTION CLASS
 // ============================================================================
@@ -31,8 +35,21 @@
 class ReadCorrection
 {
 private:
+        static const int window_overlap_ = 2000; // overlap of the windows of a split read
+
         const Graph &graph_;
         const Settings &settings_;
+        std::vector<SeedTable> seeds_;       // seed storage, reused between chunks
+        std::vector<std::string> sequences_; // reads that are not plain ACGT, mapped onto it
+        CorrectionContext context_;          // buffers reused between reads
+        WindowPool *windowPool_;             // helpers for split reads, may be NULL
+
+        /**
+         * Find the seeds of a single read
+         * @param read The read
+         * @param seeds Seeds between the read and the graph (output)
+         */
+        void findSeeds(const Read& read, SeedTable& seeds);
 
         /**
          * Correct a specific read record
@@ -46,6 +63,34 @@ private:
          */
         void correctRead(ReadRecord& record);
 
+        /**
+         * Correct a specific read record using its precomputed seeds
+         * @param record Record to correct (input/output)
+         * @param read The read of the record
+         * @param seeds Seeds between the read and the graph
+         */
+        void correctRead(ReadRecord& record, Read& read, SeedTable& seeds);
+
+        /**
+         * Correct a read that is longer than the split length: overlapping
+         * windows of the read are seeded and aligned, together with the
+         * window pool, and their local alignments are stitched together
+         * @param record Record to correct (input/output)
+         * @param read The read of the record
+         */
+        void correctLongRead(ReadRecord& record, Read& read);
+
+        /**
+         * Seed a window of a read and align it to the graph
+         * @param window The window, as a read of its own
+         * @param context Buffers of the calling thread
+         * @param alignments Local alignments of the window (output)
+         * @param paths Arena holding the paths of the alignments (output)
+         */
+        void alignWindow(Read& window, CorrectionContext& context,
+                         std::vector<LocalAlignment>& alignments,
+                         PathArena& paths);
+
         /**
          * Find the node position pairs for a read using EssaMEM
          * @param read Reference to the read
@@ -62,9 +107,12 @@ public:
          * Default constructor
          * @param graph_ Reference to the De Bruijn graph
          * @param settings_ Reference to the settings class
+         * @param windowPool Helpers for the windows of split reads, or NULL
          */
-        ReadCorrection(const Graph& graph, const Settings& settings) :
-                          graph_(graph), settings_(settings){}
+        ReadCorrection(const Graph& graph, const Settings& settings,
+                       WindowPool *windowPool = NULL) :
+                          graph_(graph), settings_(settings),
+                          windowPool_(windowPool){}
         /**
          * Correct the records in one chunk
          * @param readChunk Chunk of records to correct
@@ -86,8 +134,10 @@ private:
          * Entry routine for worker thread
          * @param myID Unique threadID
          * @param libaries Library container with libraries to be corrected
+         * @param windowPool Helpers for the windows of split reads, or NULL
          */
-        void workerThread(size_t myID, LibraryContainer& libraries);
+        void workerThread(size_t myID, LibraryContainer& libraries,
+                          WindowPool* windowPool);
 
 public:
         /**
@@ -20,21 +20,30 @@
 #ifndef SEED_HPP
 #define SEED_HPP
 
+#include <string>
+
 class Seed{
         private:
                 int node_; //node containing the seed
                 int ref_start_; //offset in reference                
                 int read_start_; //offset in read
                 int length_; //length of the seed
+                int multiplicity_; //size of the index interval the seed was
+                                   //found in, 1 if unknown
+                int path_; //nodes the seed runs through in its SeedTable,
+                           //-1 if it lies within its node
         public:
                 /*
                  *        ctors
                  */
-                Seed(int node, int ref_start, int read_start, int length) : 
+                Seed(int node, int ref_start, int read_start, int length,
+                        int multiplicity = 1, int path = -1) :
                         node_(node),
                         ref_start_(ref_start),
                         read_start_(read_start),
-                        length_(length)
+                        length_(length),
+                        multiplicity_(multiplicity),
+                        path_(path)
                         {}
                 /*
                  *        methods
@@ -46,6 +55,8 @@ class Seed{
                 int get_read_start() const {return read_start_;}
                 int get_read_end() const {return read_start_ + length_;}
                 int get_length() const {return length_;}
+                int get_multiplicity() const {return multiplicity_;}
+                int get_path() const {return path_;}
                 //string representation, for debugging purposes
                 std::string to_string() const {
                         std::string result = "";
@@ -57,6 +68,8 @@ class Seed{
                         result += " ";
                         result += std::to_string(get_length());
                         result += " ";
+                        result += std::to_string(get_multiplicity());
+                        result += " ";
                         return result;
                 }
                 //check if the seed is contained in the segment
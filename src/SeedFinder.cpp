@@ -24,9 +24,17 @@
 #include <fstream>
 
 #include "Seed.hpp"
+#include "Numa.hpp"
+#include "IndexPlanner.hpp"
+#include "MatchFinder.hpp"
+#include "MinimizerIndex.hpp"
+#include "FMIndex.hpp"
 #include "mummer/sparseSA.hpp"
 
+const int SeedFinder::max_presence_k_;
+
 SeedFinder::~SeedFinder() {
+        delete finder_;
         delete sa_;
 }
 
@@ -37,22 +45,30 @@ void SeedFinder::addNodeToReference(std::string const &node) {
         nodes_index_.push_back(size);
 }
 
-int SeedFinder::binary_node_search(long const &mem_start) const {
-        long signed left = 0;
-        long signed mid;
-        long signed right = nodes_index_.size();
-        while (left + 1 != right) {
-                mid = (left + right) / 2;
-                if (nodes_index_.at(mid) < mem_start) {
-                        left = mid;
-                } else if (nodes_index_.at(mid) > mem_start) {
-                        right = mid;
-                } else {
-                        left = mid;
-                        right = mid + 1;
+void SeedFinder::init_node_lookup() {
+        //entry b holds the last node boundary at or before position b << shift
+        long blocks = (nodes_index_.back() >> lookup_shift_) + 1;
+        node_lookup_.assign(blocks, 0);
+        int entry = 0;
+        for (long b = 0; b < blocks; ++b) {
+                long pos = b << lookup_shift_;
+                while (entry + 1 < (int)nodes_index_.size()
+                        && nodes_index_[entry + 1] <= pos)
+                {
+                        ++entry;
                 }
+                node_lookup_[b] = entry;
         }
-        return (((left + 2) / 2)) * (left % 2 == 0 ? 1 : -1);
+}
+
+int SeedFinder::node_search(long const &mem_start) const {
+        //nodes are at least one k-mer long, so only a few boundaries follow
+        //the sampled one
+        long entry = node_lookup_[mem_start >> lookup_shift_];
+        while (nodes_index_[entry + 1] <= mem_start) {
+                ++entry;
+        }
+        return (((entry + 2) / 2)) * (entry % 2 == 0 ? 1 : -1);
 }
 
 int SeedFinder::startOfHit(int node_nr, long start_in_ref) const {
@@ -61,39 +77,240 @@ int SeedFinder::startOfHit(int node_nr, long start_in_ref) const {
         return (int) (start_in_ref - start_of_node);
 }
 
+int SeedFinder::matchForward(int node_id, int node_pos,
+        std::string const &read, int read_pos) const
+{
+        int index = 2 * node_id * (node_id < 0 ? -1 : 1) - 2 + (node_id < 0);
+        long pos = nodes_index_[index];
+        long len = nodes_index_[index + 1] - pos - 1;
+        long n = std::min(len - node_pos, (long)read.size() - read_pos);
+        if (n <= 0) {
+                return 0;
+        }
+        return common_prefix(reference_.data() + pos + node_pos,
+                read.data() + read_pos, n);
+}
+
+int SeedFinder::matchBackward(int node_id, int node_end,
+        std::string const &read, int read_end) const
+{
+        int index = 2 * node_id * (node_id < 0 ? -1 : 1) - 2 + (node_id < 0);
+        long pos = nodes_index_[index];
+        long n = std::min(node_end, read_end);
+        if (n <= 0) {
+                return 0;
+        }
+        return common_suffix(reference_.data() + pos + node_end,
+                read.data() + read_end, n);
+}
+
+//adds the MEMs of a read to its seed table as findMEM reports them
+class SeedBinner : public mem_visitor_t {
+        private:
+                SeedFinder const &finder_;
+                SeedTable &seeds_;
+                int offset_; //start in the read of the searched sequence
+        public:
+                SeedBinner(SeedFinder const &finder, SeedTable &seeds,
+                        int offset = 0)
+                      :        finder_(finder), seeds_(seeds), offset_(offset)
+                {}
+                void visit(match_t const &m) {
+                        int node_nr = finder_.node_search(m.ref);
+                        int node_start = finder_.startOfHit(node_nr, m.ref);
+                        seeds_.add(Seed(node_nr, node_start, offset_ + m.query, m.len,
+                                m.occ));
+                }
+};
+
+void SeedFinder::init_kmer_presence(int k) {
+        if (k <= 0) {
+                return;
+        }
+        presence_k_ = k;
+        kmer_presence_.assign(((1ULL << (2 * k)) + 63) / 64, 0);
+        uint64_t mask = (1ULL << (2 * k)) - 1;
+        uint64_t code = 0;
+        int valid = 0;
+        for (size_t i = 0; i < reference_.size(); ++i) {
+                unsigned int c = BITADD[(unsigned char)reference_[i]];
+                if (c > 3) {
+                        valid = 0;
+                        continue;
+                }
+                code = ((code << 2) | c) & mask;
+                if (++valid >= k) {
+                        kmer_presence_[code >> 6] |= 1ULL << (code & 63);
+                }
+        }
+}
+
+std::vector<bool> const *SeedFinder::maskAbsentKmers(std::string const &read,
+        std::vector<bool> const *skip, std::vector<bool> &mask) const
+{
+        if (presence_k_ == 0) {
+                return skip;
+        }
+        if (skip != NULL) {
+                mask = *skip;
+        } else {
+                mask.assign(read.size(), false);
+        }
+        //k-mers with other characters than ACGT are not masked
+        uint64_t kmer_mask = (1ULL << (2 * presence_k_)) - 1;
+        uint64_t code = 0;
+        int valid = 0;
+        for (size_t i = 0; i < read.size(); ++i) {
+                unsigned int c = BITADD[(unsigned char)read[i]];
+                if (c > 3) {
+                        valid = 0;
+                        continue;
+                }
+                code = ((code << 2) | c) & kmer_mask;
+                if (++valid >= presence_k_
+                        && !((kmer_presence_[code >> 6] >> (code & 63)) & 1))
+                {
+                        mask[i + 1 - presence_k_] = true;
+                }
+        }
+        return &mask;
+}
+
 void SeedFinder::getSeeds(std::string const &read,
-        std::map<int, std::vector<Seed>> &seed_map,
-        std::vector<int> &seeds_of_size, std::vector<int> &map_keys,
-        int &seed_count, int const &seed_min_length) const
+        std::vector<bool> const *skip, SeedTable &seeds,
+        int const &seed_min_length) const
+{
+        SeedBinner binner(*this, seeds);
+        finder_->findMatches(read, maskAbsentKmers(read, skip,
+                seeds.get_search_mask()), binner, seed_min_length);
+        seeds.sort();
+}
+
+void SeedFinder::getSeeds(std::vector<std::string const *> const &reads,
+        std::vector<std::vector<bool> const *> const &skips,
+        std::vector<SeedTable *> const &seeds,
+        int const &seed_min_length) const
+{
+        std::vector<SeedBinner> binners;
+        binners.reserve(reads.size());
+        std::vector<mem_visitor_t *> visitors;
+        for (size_t i = 0; i < reads.size(); ++i) {
+                binners.push_back(SeedBinner(*this, *seeds[i]));
+                visitors.push_back(&binners.back());
+        }
+        std::vector<std::vector<bool> const *> read_skips(reads.size());
+        for (size_t i = 0; i < reads.size(); ++i) {
+                read_skips[i] = maskAbsentKmers(*reads[i], skips[i],
+                        seeds[i]->get_search_mask());
+        }
+        finder_->findMatches(reads, read_skips, visitors, seed_min_length);
+        for (size_t i = 0; i < seeds.size(); ++i) {
+                seeds[i]->sort();
+        }
+}
+
+void SeedFinder::addSeeds(std::string const &read,
+        std::vector<bool> const *skip,
+        std::vector<std::pair<int, int> > const &segments, SeedTable &seeds,
+        int const &seed_min_length) const
 {
-        //mem finding
-        vector<match_t> matches;        //will contain the matches
-        bool print = 0;        //not sure what it prints if set to 1
-        sa_->findMEM(0, read, matches, seed_min_length, print);
-
-        //parse the results
-        for (int i = 0; i < matches.size(); ++i) {
-                match_t m = matches[i];
-                int node_nr = binary_node_search(m.ref);
-                int node_start = startOfHit(node_nr, m.ref);
-                seed_map[node_nr].push_back(Seed(node_nr, node_start, m.query, m.len));
-                while (seeds_of_size.size() <= m.len) {
-                        seeds_of_size.push_back(0);
+        std::vector<bool> segment_skip;
+        std::vector<bool> &mask = seeds.get_search_mask();
+        for (size_t i = 0; i < segments.size(); ++i) {
+                int start = segments[i].first;
+                int size = segments[i].second - start;
+                if (size < seed_min_length) {
+                        continue;
                 }
-                ++seeds_of_size[m.len];
-                ++seed_count;
-                if (std::find(map_keys.begin(), map_keys.end(), node_nr) == map_keys.end()) {
-                        map_keys.push_back(node_nr);
+                if (skip != NULL) {
+                        segment_skip.assign(skip->begin() + start,
+                                skip->begin() + start + size);
                 }
+                std::string segment = read.substr(start, size);
+                SeedBinner binner(*this, seeds, start);
+                finder_->findMatches(segment, maskAbsentKmers(segment,
+                        skip != NULL ? &segment_skip : NULL, mask), binner,
+                        seed_min_length);
+        }
+        seeds.removeDuplicates();
+        seeds.sort();
+}
+
+void SeedFinder::plan_index(bool &suflink, bool &child, bool &kmer,
+        int kmer_size)
+{
+        //the suffix array holds 32 bit integers
+        int suggestion = 1 + (reference_.size() >> 31);
+        IndexPlanner planner(reference_.size(), std::max(k_, suggestion),
+                min_length_, kmer_size, settings_.get_index_mem() << 20);
+        IndexPlan const &plan = planner.plan();
+        if (settings_.get_dry_run()) {
+                planner.printReport(std::cout);
+                exit(EXIT_SUCCESS);
+        }
+        if (k_ < plan.k) {
+                std::cout << "Increasing sparseness factor from " << k_ << " to " << plan.k << "." << std::endl;
+                k_ = plan.k;
+        }
+        suflink = plan.suflink;
+        child = plan.child;
+        kmer = plan.kmer;
+        staged_ = plan.staged;
+        if (staged_) {
+                std::cout << "Building the index in stages, an in-memory build needs "
+                        << (sparseSA::construction_peak_bytes(reference_.size(),
+                        k_, suflink, child, kmer, kmer_size, false) >> 20)
+                        << " MB." << std::endl;
+        }
+}
+
+void SeedFinder::init_index(std::string const &meta) {
+        init_node_lookup();
+        if (settings_.get_seeder() == SEED_MINIMIZER) {
+                init_minimizers();
+        } else if (settings_.get_seeder() == SEED_FM) {
+                init_fm_index(meta);
+        } else {
+                init_essaMEM(meta);
+        }
+        if (settings_.get_numa()) {
+                //every worker reads the whole index, spread it over the nodes
+                Numa::interleave(reference_.data(), reference_.size());
+                Numa::interleave(nodes_index_.data(), nodes_index_.size() * sizeof(long));
+                Numa::interleave(node_lookup_.data(), node_lookup_.size() * sizeof(int));
+        }
+        if (settings_.get_huge_pages() != HP_OFF) {
+                HugePages::advise(reference_.data(), reference_.size());
+                std::cout << "INDEX ON HUGE PAGES IN BYTES: "
+                        << HugePages::bytes_on_huge_pages() << " of "
+                        << HugePages::bytes_mapped() << " eligible" << endl;
         }
 }
 
-void SeedFinder::compute_sparseness() {
-        auto suggestion = 1 + (reference_.size() >> 31);
-        if (k_ < suggestion) {
-                std::cout << "Increasing sparseness factor from " << k_ << " to " << suggestion << "." << std::endl;
-                k_ = suggestion;
+void SeedFinder::init_minimizers() {
+        //a match of min_length_ spans a full window, so it holds a minimizer
+        int k = std::min(16, (min_length_ + 1) / 2);
+        int w = std::max(1, min_length_ - k + 1);
+        std::cout << "Constructing minimizer index (w = " << w << ", k = "
+                << k << ")... " << std::endl;
+        finder_ = new MinimizerIndex(reference_, k, w,
+                settings_.get_num_threads(), settings_.get_max_occ());
+        std::cout << "Done." << std::endl;
+        std::cout << "INDEX SIZE IN BYTES: " << finder_->size_in_bytes() << endl;
+}
+
+void SeedFinder::init_fm_index(std::string const &meta) {
+        std::cout << "Constructing FM index... " << std::endl;
+        FMIndex *fm = new FMIndex(reference_, fm_sample_rate_,
+                settings_.get_max_occ());
+        finder_ = fm;
+        std::string prefix = settings_.get_directory() + "/" + meta + "_fm";
+        if (!fm->load(prefix)) {
+                fm->construct();
+                fm->save(prefix);
         }
+        std::cout << "Done." << std::endl;
+        std::cout << "INDEX SIZE IN BYTES: " << finder_->size_in_bytes() << endl;
 }
 
 void SeedFinder::init_essaMEM(std::string const &meta) {
@@ -102,14 +319,12 @@ void SeedFinder::init_essaMEM(std::string const &meta) {
         refdescr.push_back(meta);
         std::vector<long> startpos;
         startpos.push_back(0); //only one reference
-        bool suflink = true;
-        bool child = true;
-        bool kmer = true;
+        bool suflink, child, kmer;
         int sparseMult = 1;
         int kmer_size = 9;
         bool printSubstring = false;
         bool printRevCompForw = false;
-        compute_sparseness();
+        plan_index(suflink, child, kmer, kmer_size);
         sa_ = new sparseSA(
                 reference_,                //reference string
                 refdescr,                //description of the ref
@@ -131,10 +346,27 @@ void SeedFinder::init_essaMEM(std::string const &meta) {
         (*prefixstream) << settings_.get_directory() << "/" << meta << "_" << k_ << "_" << suflink << "_" << child;
         string prefix = prefixstream->str();
         if (!sa_->load(prefix)) {
-                sa_->construct();
-                sa_->save(prefix);
+                if (staged_) {
+                        sa_->construct(prefix);
+                        sa_->load(prefix);
+                } else {
+                        sa_->construct();
+                        sa_->save(prefix);
+                }
         }
         delete prefixstream;
+        sa_->maxOcc = settings_.get_max_occ();
+        finder_ = new EssaMatchFinder(*sa_);
+        //the traversal from an offset matches at least min_length_ - (k_ - 1)
+        //bases, so offsets whose first k-mer is absent can be skipped
+        init_kmer_presence(std::min(max_presence_k_, min_length_ - (k_ - 1)));
         std::cout << "Done." << std::endl;
-        std::cout << "INDEX SIZE IN BYTES: " << sa_->index_size_in_bytes() << endl;
+        std::cout << "INDEX SIZE IN BYTES: " << finder_->size_in_bytes() << endl;
+        if (settings_.get_numa()) {
+                Numa::interleave(sa_->SA.data(), sa_->SA.size() * sizeof(unsigned int));
+                Numa::interleave(sa_->ISA.data(), sa_->ISA.size() * sizeof(int));
+                Numa::interleave(sa_->LCP.vec.data(), sa_->LCP.vec.size());
+                Numa::interleave(sa_->CHILD.data(), sa_->CHILD.size() * sizeof(int));
+                Numa::interleave(sa_->KMR.data(), sa_->KMR.size() * sizeof(saTuple_t));
+        }
 }
@@ -24,20 +24,45 @@
 #include <string>
 #include <map>
 #include <iostream>
+#include <cstdint>
 #include "Settings.hpp"
+#include "SeedTable.hpp"
 
 class sparseSA;
-class Seed;
+class MatchFinder;
 
 class SeedFinder{
         private:
+                static const int lookup_shift_ = 5; //2^shift positions per
+                                                    //node lookup sample
+                static const int fm_sample_rate_ = 32; //text positions per
+                                                       //FM index sample
+                static const int max_presence_k_ = 12; //largest k of the
+                                                       //k-mer presence filter
                 Settings const &settings_;
                 int min_length_; //min length of seeds
                 int k_; //sparseness factor
+                bool staged_; //build the index straight to disk
                 sparseSA * sa_; //suffix array
+                MatchFinder * finder_; //finds the matches behind the seeds
                 std::string reference_; //sparseSA requires the sequence from
                                         //which it is built to be kept in memory
-                std::vector<long> nodes_index_; //list containing size of nodes
+                std::vector<long, HugePageAllocator<long> > nodes_index_; //list containing size of nodes
+                std::vector<int> node_lookup_; //last entry of nodes_index_ per
+                                               //block of the reference
+                int presence_k_; //k-mer size of the presence filter, 0 = none
+                std::vector<uint64_t> kmer_presence_; //bit per k-mer that
+                                                      //occurs in the reference
+                /*
+                 *        methods
+                 */
+                //mark which k-mers occur in the reference
+                void init_kmer_presence(int k);
+                //mark the read positions whose k-mer does not occur in the
+                //reference on top of skip, returns the mask to search with
+                std::vector<bool> const *maskAbsentKmers(std::string const &read,
+                        std::vector<bool> const *skip,
+                        std::vector<bool> &mask) const;
 
         public:
                 /*
@@ -48,6 +73,10 @@ class SeedFinder{
                 {
                         min_length_ = settings.get_min_len();
                         k_ = settings.get_essa_k();
+                        staged_ = false;
+                        sa_ = NULL;
+                        finder_ = NULL;
+                        presence_k_ = 0;
                         nodes_index_.push_back(0);
                 }
                 void init();
@@ -59,20 +88,49 @@ class SeedFinder{
                  *        methods
                  */
                 void addNodeToReference(std::string const &node);
+                //initialise the index of the selected seeder
+                void init_index(std::string const &meta);
                 //initialise the ESSA
                 void init_essaMEM(std::string const &meta);
-                //increase sparseness factor, should the need arise
-                void compute_sparseness();
-                //find seeds between read and the graph
+                //initialise the minimizer index
+                void init_minimizers();
+                //initialise the FM index, load it from the output directory
+                //when an earlier run stored it
+                void init_fm_index(std::string const &meta);
+                //choose the index configuration, within the memory budget
+                void plan_index(bool &suflink, bool &child, bool &kmer,
+                        int kmer_size);
+                //find seeds between read and the graph, no seeds start at the
+                //read positions marked in skip (if not NULL)
                 void getSeeds(std::string const &read,
-                        std::map<int, std::vector<Seed>> &seed_map,
-                        std::vector<int> &seeds_of_size,
-                        std::vector<int> &map_keys, int &seed_count,
+                        std::vector<bool> const *skip, SeedTable &seeds,
+                        int const &seed_min_length) const;
+                //find the seeds of many reads at once, seeds[i] receives
+                //the seeds of reads[i]
+                void getSeeds(std::vector<std::string const *> const &reads,
+                        std::vector<std::vector<bool> const *> const &skips,
+                        std::vector<SeedTable *> const &seeds,
                         int const &seed_min_length) const;
+                //find the seeds within segments of a read and add them to the
+                //seeds it already has, seeds found before are not repeated
+                void addSeeds(std::string const &read,
+                        std::vector<bool> const *skip,
+                        std::vector<std::pair<int, int> > const &segments,
+                        SeedTable &seeds, int const &seed_min_length) const;
+                //sample the node boundaries for node_search
+                void init_node_lookup();
                 //find the node in which a seed is contained
-                int binary_node_search(long const &mem_start) const;
+                int node_search(long const &mem_start) const;
                 //find where in the node the seed starts
                 int startOfHit(int node_nr, long start_in_ref) const;
+                //length of the exact match of the read from read_pos on with
+                //a node from node_pos on
+                int matchForward(int node_id, int node_pos,
+                        std::string const &read, int read_pos) const;
+                //length of the exact match of the read before read_end with
+                //a node before node_end
+                int matchBackward(int node_id, int node_end,
+                        std::string const &read, int read_end) const;
                 //
                 std::string getNode(int const node_id) const {
                         int index = 2 * node_id * (node_id < 0 ? -1 : 1) - 2 + (node_id < 0);
@@ -80,5 +138,15 @@ class SeedFinder{
                         long len = nodes_index_[index + 1] - pos - 1;
                         return reference_.substr(pos, len);
                 }
+                //append the sequence of a node from offset on to out
+                void appendNode(int const node_id, int offset,
+                        std::string &out) const {
+                        int index = 2 * node_id * (node_id < 0 ? -1 : 1) - 2 + (node_id < 0);
+                        long pos = nodes_index_[index];
+                        long len = nodes_index_[index + 1] - pos - 1;
+                        if (offset < len) {
+                                out.append(reference_, pos + offset, len - offset);
+                        }
+                }
 };
 #endif
@@ -0,0 +1,309 @@
+/*******************************************************************************
+ *   Copyright (C) 2014, 2015 Giles Miclotte (giles.miclotte@intec.ugent.be)   *
+ *   This file is part of Jabba                                                *
+ *                                                                             *
+ *   This program is free software; you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published by      *
+ *   the Free Software Foundation; either version 2 of the License, or         *
+ *   (at your option) any later version.                                       *
+ *                                                                             *
+ *   This program is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *   GNU General Public License for more details.                              *
+ *                                                                             *
+ *   You should have received a copy of the GNU General Public License         *
+ *   along with this program; if not, write to the                             *
+ *   Free Software Foundation, Inc.,                                           *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.                 *
+ *******************************************************************************/
+#include "SeedTable.hpp"
+
+#include <algorithm>
+#include <climits>
+
+#include "Graph.hpp"
+
+//orders the seeds on their node, then on their diagonal
+static bool diagonalBefore(SeedDiagonal const &a, SeedDiagonal const &b) {
+        if (a.node != b.node) {
+                return a.node < b.node;
+        }
+        return a.diagonal < b.diagonal;
+}
+
+void SeedTable::removeDuplicates() {
+        //order the seeds on all their fields, then keep the first of a run
+        order_.resize(seeds_.size());
+        for (int i = 0; i < order_.size(); ++i) {
+                order_[i] = i;
+        }
+        std::vector<Seed> const &seeds = seeds_;
+        std::sort(order_.begin(), order_.end(),
+                [&seeds](int const &a, int const &b) {
+                        Seed const &s = seeds[a];
+                        Seed const &t = seeds[b];
+                        if (s.get_node() != t.get_node())
+                                return s.get_node() < t.get_node();
+                        if (s.get_ref_start() != t.get_ref_start())
+                                return s.get_ref_start() < t.get_ref_start();
+                        if (s.get_read_start() != t.get_read_start())
+                                return s.get_read_start() < t.get_read_start();
+                        if (s.get_length() != t.get_length())
+                                return s.get_length() < t.get_length();
+                        return a < b;
+                });
+        std::vector<bool> &duplicate = duplicate_;
+        duplicate.assign(seeds_.size(), false);
+        for (int i = 1; i < order_.size(); ++i) {
+                Seed const &s = seeds_[order_[i - 1]];
+                Seed const &t = seeds_[order_[i]];
+                duplicate[order_[i]] = s.get_node() == t.get_node()
+                        && s.get_ref_start() == t.get_ref_start()
+                        && s.get_read_start() == t.get_read_start()
+                        && s.get_length() == t.get_length();
+        }
+        int size = 0;
+        for (int i = 0; i < seeds_.size(); ++i) {
+                if (!duplicate[i]) {
+                        seeds_[size++] = seeds_[i];
+                }
+        }
+        seeds_.erase(seeds_.begin() + size, seeds_.end());
+}
+
+void SeedTable::sort() {
+        //order the seeds on node id, then along the read and the node, so
+        //the order does not depend on the order in which the seeds are
+        //found; the index breaks the ties between equal seeds
+        order_.resize(seeds_.size());
+        for (int i = 0; i < order_.size(); ++i) {
+                order_[i] = i;
+        }
+        std::vector<Seed> const &seeds = seeds_;
+        std::sort(order_.begin(), order_.end(),
+                [&seeds](int const &a, int const &b) {
+                        Seed const &s = seeds[a];
+                        Seed const &t = seeds[b];
+                        if (s.get_node() != t.get_node())
+                                return s.get_node() < t.get_node();
+                        if (s.get_read_start() != t.get_read_start())
+                                return s.get_read_start() < t.get_read_start();
+                        if (s.get_ref_start() != t.get_ref_start())
+                                return s.get_ref_start() < t.get_ref_start();
+                        if (s.get_length() != t.get_length())
+                                return s.get_length() < t.get_length();
+                        return a < b;
+                });
+        //find the run of each node in order_
+        ranges_.clear();
+        for (int i = 0; i < order_.size(); ) {
+                int node = seeds_[order_[i]].get_node();
+                int j = i + 1;
+                while (j < order_.size() && seeds_[order_[j]].get_node() == node) {
+                        ++j;
+                }
+                ranges_.push_back({node, i, j});
+                i = j;
+        }
+        //put the nodes in order of their first seed along the read
+        std::vector<int> const &order = order_;
+        std::sort(ranges_.begin(), ranges_.end(),
+                [&order, &seeds](NodeRange const &a, NodeRange const &b) {
+                        Seed const &s = seeds[order[a.begin]];
+                        Seed const &t = seeds[order[b.begin]];
+                        if (s.get_read_start() != t.get_read_start())
+                                return s.get_read_start() < t.get_read_start();
+                        if (s.get_ref_start() != t.get_ref_start())
+                                return s.get_ref_start() < t.get_ref_start();
+                        return a.node < b.node;
+                });
+        sorted_.clear();
+        for (NodeRange &range : ranges_) {
+                int begin = sorted_.size();
+                for (int i = range.begin; i < range.end; ++i) {
+                        sorted_.push_back(seeds_[order_[i]]);
+                }
+                range.begin = begin;
+                range.end = sorted_.size();
+        }
+        seeds_.swap(sorted_);
+        sorted_.clear();
+        //index the seeds on their start in the read
+        by_start_.resize(seeds_.size());
+        for (int i = 0; i < by_start_.size(); ++i) {
+                by_start_[i] = i;
+        }
+        std::sort(by_start_.begin(), by_start_.end(),
+                [&seeds](int const &a, int const &b) {
+                        if (seeds[a].get_read_start() != seeds[b].get_read_start())
+                                return seeds[a].get_read_start() < seeds[b].get_read_start();
+                        return a < b;
+                });
+}
+
+void SeedTable::getSeedsInSegment(int segment_start, int segment_end,
+        std::vector<int> &indices) const
+{
+        //only the seeds starting in the segment can lie within it
+        std::vector<Seed> const &seeds = seeds_;
+        auto first = std::lower_bound(by_start_.begin(), by_start_.end(),
+                segment_start, [&seeds](int const &i, int const &pos) {
+                        return seeds[i].get_read_start() < pos;
+                });
+        auto last = std::upper_bound(first, by_start_.end(), segment_end,
+                [&seeds](int const &pos, int const &i) {
+                        return pos < seeds[i].get_read_start();
+                });
+        indices.clear();
+        for (auto it = first; it != last; ++it) {
+                if (seeds_[*it].isInReadSegment(segment_start, segment_end)) {
+                        indices.push_back(*it);
+                }
+        }
+        std::sort(indices.begin(), indices.end());
+}
+
+void SeedTable::markJoined(Seed const &anchor, Graph const &graph) {
+        //a seed of the match lies on the diagonal of the anchor, shifted by
+        //the start of its node in the path
+        int const *path = &paths_[anchor.get_path()];
+        int diagonal = anchor.get_read_start() - anchor.get_ref_start();
+        for (int p = 1; p <= path[0]; ++p) {
+                if (p > 1) {
+                        diagonal += graph.getSizeOfNode(path[p - 1])
+                                - graph.get_overlap();
+                }
+                auto range = std::equal_range(diagonals_.begin(),
+                        diagonals_.end(), SeedDiagonal{path[p], diagonal, -1},
+                        diagonalBefore);
+                for (auto it = range.first; it != range.second; ++it) {
+                        Seed const &s = seeds_[it->seed];
+                        if (anchor.get_read_start() <= s.get_read_start()
+                                && s.get_read_end() <= anchor.get_read_end())
+                        {
+                                joined_[it->seed] = true;
+                        }
+                }
+        }
+}
+
+void SeedTable::join(std::string const &read, Graph const &graph) {
+        int overlap = graph.get_overlap();
+        diagonals_.clear();
+        for (int i = 0; i < seeds_.size(); ++i) {
+                Seed const &s = seeds_[i];
+                if (s.get_path() < 0) {
+                        diagonals_.push_back({s.get_node(),
+                                s.get_read_start() - s.get_ref_start(), i});
+                }
+        }
+        std::sort(diagonals_.begin(), diagonals_.end(), diagonalBefore);
+        //the seeds joined by an earlier search cover the seeds found again
+        joined_.assign(seeds_.size(), false);
+        for (Seed const &s : seeds_) {
+                if (s.get_path() >= 0) {
+                        markJoined(s, graph);
+                }
+        }
+        //continue the matches along the read, so every match is continued
+        //from its first seed and its other seeds are skipped
+        anchors_.clear();
+        anchor_of_.assign(seeds_.size(), -1);
+        for (int i : by_start_) {
+                Seed const &s = seeds_[i];
+                if (joined_[i] || s.get_path() >= 0) {
+                        continue;
+                }
+                int node = s.get_node();
+                int node_start = s.get_ref_start();
+                int node_end = s.get_ref_end();
+                int size = graph.getSizeOfNode(node);
+                if (node_start > 0 && node_end < size) {
+                        continue;
+                }
+                //a seed within the overlap with the neighbours does not tell
+                //which of them the read runs through, the seeds of the
+                //neighbours that reach beyond the overlap are continued
+                if (node_end <= overlap || node_start >= size - overlap) {
+                        continue;
+                }
+                int read_start = s.get_read_start();
+                int read_end = s.get_read_end();
+                pre_path_.assign(1, node);
+                graph.extendMatchBackward(read, pre_path_, node_start,
+                        read_start, edges_);
+                post_path_.assign(1, node);
+                graph.extendMatchForward(read, post_path_, node_end,
+                        read_end, edges_);
+                if (pre_path_.size() == 1 && post_path_.size() == 1) {
+                        continue;
+                }
+                int path = paths_.size();
+                paths_.push_back(pre_path_.size() + post_path_.size() - 1);
+                paths_.insert(paths_.end(), pre_path_.rbegin(), pre_path_.rend());
+                paths_.insert(paths_.end(), post_path_.begin() + 1,
+                        post_path_.end());
+                anchor_of_[i] = anchors_.size();
+                anchors_.push_back(Seed(pre_path_.back(), node_start,
+                        read_start, read_end - read_start,
+                        s.get_multiplicity(), path));
+                markJoined(anchors_.back(), graph);
+        }
+        if (anchors_.empty()) {
+                return;
+        }
+        //a seed within the overlap of its node is a copy of the part of a
+        //match that its neighbours share, it is dropped when an anchor
+        //covers it on the read
+        spans_.clear();
+        for (Seed const &s : seeds_) {
+                if (s.get_path() >= 0) {
+                        spans_.push_back(std::make_pair(s.get_read_start(),
+                                s.get_read_end()));
+                }
+        }
+        for (Seed const &s : anchors_) {
+                spans_.push_back(std::make_pair(s.get_read_start(),
+                        s.get_read_end()));
+        }
+        std::sort(spans_.begin(), spans_.end());
+        for (int i = 1; i < spans_.size(); ++i) {
+                spans_[i].second = std::max(spans_[i].second,
+                        spans_[i - 1].second);
+        }
+        for (int i = 0; i < seeds_.size(); ++i) {
+                Seed const &s = seeds_[i];
+                if (joined_[i] || s.get_path() >= 0 || (s.get_ref_end() > overlap
+                        && s.get_ref_start() < graph.getSizeOfNode(s.get_node())
+                        - overlap))
+                {
+                        continue;
+                }
+                auto it = std::upper_bound(spans_.begin(), spans_.end(),
+                        std::make_pair(s.get_read_start(), INT_MAX));
+                joined_[i] = it != spans_.begin()
+                        && s.get_read_end() <= (it - 1)->second;
+        }
+        //replace the seeds of the continued matches by their anchors, an
+        //anchor takes the place of the seed it was continued from
+        int size = 0;
+        for (int i = 0; i < seeds_.size(); ++i) {
+                if (anchor_of_[i] >= 0) {
+                        seeds_[size++] = anchors_[anchor_of_[i]];
+                } else if (!joined_[i]) {
+                        seeds_[size++] = seeds_[i];
+                }
+        }
+        seeds_.erase(seeds_.begin() + size, seeds_.end());
+        sort();
+}
+
+void SeedTable::getPath(int node, int path, std::vector<int> &nodes) const {
+        if (path < 0) {
+                nodes.assign(1, node);
+                return;
+        }
+        int const *p = &paths_[path];
+        nodes.assign(p + 1, p + 1 + p[0]);
+}
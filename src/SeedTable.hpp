@@ -0,0 +1,113 @@
+/*******************************************************************************
+ *   Copyright (C) 2014, 2015 Giles Miclotte (giles.miclotte@intec.ugent.be)   *
+ *   This file is part of Jabba                                                *
+ *                                                                             *
+ *   This program is free software; you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published by      *
+ *   the Free Software Foundation; either version 2 of the License, or         *
+ *   (at your option) any later version.                                       *
+ *                                                                             *
+ *   This program is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *   GNU General Public License for more details.                              *
+ *                                                                             *
+ *   You should have received a copy of the GNU General Public License         *
+ *   along with this program; if not, write to the                             *
+ *   Free Software Foundation, Inc.,                                           *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.                 *
+ *******************************************************************************/
+#ifndef SEEDTABLE_HPP
+#define SEEDTABLE_HPP
+
+#include <vector>
+#include <string>
+#include <utility>
+
+#include "Seed.hpp"
+
+class Graph;
+
+//contiguous run of the seeds of one node in a SeedTable
+struct NodeRange {
+        int node; //node containing the seeds
+        int begin; //first seed in the table
+        int end; //one past the last seed in the table
+};
+
+//seed on a diagonal of a node, finds the seeds an anchor runs through
+struct SeedDiagonal {
+        int node; //node containing the seed
+        int diagonal; //start in the read minus start in the node
+        int seed; //index of the seed in the table
+};
+
+//flat table of the seeds of a read, 24 bytes per seed, grouped per node
+//once sorted; the storage is kept when the table is cleared, so one table
+//can be reused for many reads
+//a seed that is joined along the graph runs through several nodes, it is
+//grouped with its first node and its positions in the reference are
+//offsets in the sequence of its path
+class SeedTable{
+        private:
+                std::vector<Seed> seeds_; //the seeds, grouped per node after sort()
+                std::vector<NodeRange> ranges_; //nodes in order of their first seed
+                std::vector<int> by_start_; //seeds ordered on their start in the read
+                std::vector<int> order_; //scratch space for sort()
+                std::vector<Seed> sorted_; //scratch space for sort()
+                std::vector<bool> duplicate_; //scratch space for removeDuplicates()
+                std::vector<bool> search_mask_; //scratch space for the seed search
+                std::vector<int> paths_; //paths of the joined seeds, each is
+                                         //its size followed by its nodes
+                std::vector<SeedDiagonal> diagonals_; //scratch space for join()
+                std::vector<bool> joined_; //scratch space for join()
+                std::vector<Seed> anchors_; //scratch space for join()
+                std::vector<int> anchor_of_; //scratch space for join()
+                std::vector<std::pair<int, int> > spans_; //scratch space for join()
+                std::vector<int> pre_path_; //scratch space for join()
+                std::vector<int> post_path_; //scratch space for join()
+                std::vector<int> edges_; //scratch space for join()
+                //mark the seeds that lie on the match of a joined seed
+                void markJoined(Seed const &anchor, Graph const &graph);
+        public:
+                /*
+                 *        methods
+                 */
+                //remove all seeds, keeping the storage
+                void clear() {
+                        seeds_.clear();
+                        ranges_.clear();
+                        by_start_.clear();
+                        paths_.clear();
+                }
+                //add a seed, the table must be sorted again before use
+                void add(Seed const &seed) {seeds_.push_back(seed);}
+                //remove the seeds that were added before, keeping the order
+                //of the others; the table must be sorted again before use
+                void removeDuplicates();
+                //group the seeds per node, the nodes are ordered on their
+                //first seed along the read and the seeds of a node on their
+                //position in the read, then in the node
+                void sort();
+                //find the seeds that lie within a segment of the read, the
+                //indices are returned in table order
+                void getSeedsInSegment(int segment_start, int segment_end,
+                        std::vector<int> &indices) const;
+                //continue the seeds that reach the end or the start of their
+                //node in the neighbours while the read keeps matching, the
+                //seeds on one match are replaced by a single seed running
+                //through its nodes; the table must be sorted
+                void join(std::string const &read, Graph const &graph);
+                //get the nodes a seed in node with the given path runs through
+                void getPath(int node, int path, std::vector<int> &nodes) const;
+                //getters
+                int size() const {return seeds_.size();}
+                int get_num_nodes() const {return ranges_.size();}
+                NodeRange const &get_range(int i) const {return ranges_[i];}
+                int get_node(int i) const {return ranges_[i].node;}
+                Seed const &operator[](int i) const {return seeds_[i];}
+                //skip mask of the seed search that fills this table
+                std::vector<bool> &get_search_mask() {return search_mask_;}
+};
+
+#endif
@@ -27,6 +27,7 @@
 #include <sstream>
 #include <algorithm>
 #include <cmath>
+#include <climits>
 #include <thread>
 
 Settings::Settings(int argc, char** args)
@@ -52,8 +53,18 @@ Settings::Settings(int argc, char** args)
         //set standard values
         num_threads_ = std::thread::hardware_concurrency();
         essa_k_ = 1;
+        index_mem_ = 0;
+        dry_run_ = false;
+        huge_pages_ = HP_OFF;
+        numa_ = false;
         max_passes_ = 2;
         min_len_ = 20;
+        seed_stages_ = 1;
+        split_length_ = 100000;
+        extend_seeds_ = false;
+        max_occ_ = 0;
+        min_quality_ = 0;
+        seeder_ = SEED_ESSA;
         directory_ = "Jabba_output";
         output_mode_ = SHORT;
         std::string graph_name = "DBGraph.fasta";
@@ -81,12 +92,55 @@ Settings::Settings(int argc, char** args)
                 } else if (arg == "-e" || arg == "--essak") {
                         ++i;
                         essa_k_ = std::stoi(args[i]);
+                } else if (arg == "--index-mem") {
+                        ++i;
+                        index_mem_ = std::stol(args[i]);
+                } else if (arg == "--dry-run") {
+                        dry_run_ = true;
+                } else if (arg == "--huge-pages") {
+                        ++i;
+                        if (std::string(args[i]) == std::string("thp")) {
+                                huge_pages_ = HP_THP;
+                        } else if (std::string(args[i]) == std::string("hugetlb")) {
+                                huge_pages_ = HP_HUGETLB;
+                        } else if (std::string(args[i]) == std::string("off")) {
+                                huge_pages_ = HP_OFF;
+                        } else {
+                                std::cerr << args[i] << " is not a valid huge page mode. Use \"thp\", \"hugetlb\" or \"off\" instead.\n";
+                        }
                 } else if (arg == "-p" || arg == "--passes") {
                         ++i;
                         max_passes_ = std::stoi(args[i]);
                 } else if (arg == "-l" || arg == "--length") {
                         ++i;
                         min_len_ = std::stoi(args[i]);
+                } else if (arg == "--extend-seeds") {
+                        extend_seeds_ = true;
+                } else if (arg == "--split-length") {
+                        ++i;
+                        split_length_ = std::stoi(args[i]);
+                } else if (arg == "--seed-stages") {
+                        ++i;
+                        seed_stages_ = std::max(1, std::stoi(args[i]));
+                } else if (arg == "--seeder") {
+                        ++i;
+                        if (std::string(args[i]) == std::string("essa")) {
+                                seeder_ = SEED_ESSA;
+                        } else if (std::string(args[i]) == std::string("minimizer")) {
+                                seeder_ = SEED_MINIMIZER;
+                        } else if (std::string(args[i]) == std::string("fm")) {
+                                seeder_ = SEED_FM;
+                        } else {
+                                std::cerr << args[i] << " is not a valid seeder. Use \"essa\", \"minimizer\" or \"fm\" instead.\n";
+                        }
+                } else if (arg == "--min-quality") {
+                        ++i;
+                        min_quality_ = std::stoi(args[i]);
+                } else if (arg == "--max-occ") {
+                        ++i;
+                        max_occ_ = std::stoi(args[i]);
+                } else if (arg == "--numa") {
+                        numa_ = true;
                 } else if (arg == "-o" || arg == "--output") {
                         ++i;
                         directory_ = args[i];
@@ -106,6 +160,16 @@ Settings::Settings(int argc, char** args)
                         libraries.push_back(args[i]);
                 }
         }
+        // every extra seeding stage doubles the minimal seed length of the
+        // first stage, which has to fit in an int
+        int max_stages = 1;
+        while (min_len_ > 0 && max_stages < 31 &&
+               min_len_ <= (INT_MAX >> max_stages))
+                max_stages++;
+        if (seed_stages_ > max_stages) {
+                std::cerr << "At most " << max_stages << " seed stages are possible with a min seed size of " << min_len_ << ".\n";
+                seed_stages_ = max_stages;
+        }
         for (auto const &lib : libraries) {
                 libraries_.insert(ReadLibrary(lib, directory_));
         }
@@ -127,8 +191,30 @@ Settings::Settings(int argc, char** args)
         std::cout << "Graph is " << graph_->getInputFilename() << std::endl;
         std::cout << "DBG K is " << dbg_k_ << std::endl;
         std::cout << "ESSA K is " << essa_k_ << std::endl;
+        if (index_mem_ > 0)
+                std::cout << "Index Memory Budget is " << index_mem_ << " MB" << std::endl;
         std::cout << "Max Passes is " << max_passes_ << std::endl;
         std::cout << "Min Seed Size is " << min_len_ << std::endl;
+        if (extend_seeds_)
+                std::cout << "Seeds are extended across node boundaries" << std::endl;
+        if (split_length_ > 0)
+                std::cout << "Split Length is " << split_length_ << std::endl;
+        if (seed_stages_ > 1)
+                std::cout << "Seed Stages is " << seed_stages_ << std::endl;
+        if (seeder_ == SEED_MINIMIZER)
+                std::cout << "Seeder is minimizer" << std::endl;
+        if (seeder_ == SEED_FM)
+                std::cout << "Seeder is fm" << std::endl;
+        if (max_occ_ > 0)
+                std::cout << "Max Occurrences per MEM is " << max_occ_ << std::endl;
+        if (min_quality_ > 0)
+                std::cout << "Min Seeding Quality is " << min_quality_ << std::endl;
+        if (huge_pages_ == HP_THP)
+                std::cout << "Huge Pages are transparent" << std::endl;
+        else if (huge_pages_ == HP_HUGETLB)
+                std::cout << "Huge Pages are from hugetlbfs" << std::endl;
+        if (numa_)
+                std::cout << "NUMA Placement is on" << std::endl;
         std::cout << "Output Directory is " << directory_ << std::endl;
         std::cout << "Output Mode is ";
         if (output_mode_ == SHORT){
@@ -157,11 +243,21 @@ void Settings::printUsage() const {
         std::cout << " [options]\n";
         std::cout << "  -h\t--help\t\tdisplay help page\n";
         std::cout << "  -i\t--info\t\tdisplay information page\n";
+        std::cout << "  \t--dry-run\tprint the predicted memory use and speed of the index configurations and exit\n";
+        std::cout << "  \t--numa\t\tinterleave the index over NUMA nodes and pin threads to cores\n";
+        std::cout << "  \t--extend-seeds\tcontinue seeds that reach a node end in the neighbouring nodes while the read matches\n";
         std::cout << " [options arg]\n";
         std::cout << "  -l\t--length\tminimal seed size [default = 20]\n";
+        std::cout << "  \t--seed-stages\tseed with a minimal size of 2^(n-1) times --length first, then reseed the uncorrected parts of the read with half the size per stage [default = 1]\n";
+        std::cout << "  \t--seeder\tindex used for seeding: essa (maximal exact matches), minimizer (extended minimizer anchors) or fm (maximal exact matches from a compact FM index) [default = essa]\n";
+        std::cout << "  \t--min-quality\tdo not start seeds where the mean Phred quality of the next --length bases is below this value, FASTQ only [default = 0]\n";
+        std::cout << "  \t--max-occ\tmaximal number of occurrences reported per MEM, repeats are sampled [default = unlimited]\n";
         std::cout << "  -k\t--dbgk\t\tde Bruijn graph k-mer size\n";
         std::cout << "  -e\t--essak\t\tsparseness factor of the enhance suffix array [default = 1]\n";
+        std::cout << "  \t--index-mem\tmemory budget in MB for building and loading the enhanced suffix array [default = unlimited]\n";
+        std::cout << "  \t--huge-pages\tback the index with huge pages: thp, hugetlb or off [default = off]\n";
         std::cout << "  -t\t--threads\tnumber of threads [default = available cores]\n";
+        std::cout << "  \t--split-length\tcorrect reads longer than this in overlapping windows of this size on several threads, 0 = never [default = 100000]\n";
         std::cout << "  -p\t--passes\tmaximal number of passes per read [default = 2]\n";
         std::cout << "  -m\t--outputmode\tshort (do not extend the reads) or long (maximally extend reads) [default = short]\n";
         std::cout << " [file_options file_name]\n";
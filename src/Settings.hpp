@@ -23,6 +23,7 @@
 #include <vector>
 
 #include "library.h"
+#include "HugePages.hpp"
 
 #ifdef _MSC_VER
         #include <windows.h>
@@ -32,6 +33,7 @@
 #endif
 
 typedef enum {LONG, SHORT} OutputMode;
+typedef enum {SEED_ESSA, SEED_MINIMIZER, SEED_FM} Seeder;
 class Settings {
 private:
         int num_threads_; //maximal number of threads
@@ -39,8 +41,18 @@ private:
         ReadLibrary *graph_; //graph file
         int dbg_k_; //de Bruijn graph k-mer size
         int essa_k_; //ESSA sparseness parameter
+        long index_mem_; //memory budget for the index in MB, 0 = unlimited
+        bool dry_run_; //print the index plans and exit
+        HugePageMode huge_pages_; //back the index and graph with huge pages
+        bool numa_; //interleave the index over NUMA nodes and pin threads
         int max_passes_; //maximal number of passes
         int min_len_; //minimal seed length
+        bool extend_seeds_; //continue seeds at node ends into the neighbours
+        int split_length_; //reads longer than this are split into windows, 0 = never
+        int seed_stages_; //number of seeding stages, the length halves per stage
+        Seeder seeder_; //index used to find the seeds
+        int max_occ_; //maximal number of occurrences per MEM, 0 = unlimited
+        int min_quality_; //mean quality below which seeding skips a window, 0 = off
         OutputMode output_mode_; //what kind of output should be generated
         LibraryContainer libraries_; //libraries
         
@@ -67,8 +79,22 @@ public:
         ReadLibrary get_graph() const {return *graph_;}
         int get_dbg_k() const {return dbg_k_;}
         int get_essa_k() const {return essa_k_;}
+        long get_index_mem() const {return index_mem_;}
+        bool get_dry_run() const {return dry_run_;}
+        HugePageMode get_huge_pages() const {return huge_pages_;}
+        bool get_numa() const {return numa_;}
         int get_max_passes() const {return max_passes_;}
         int get_min_len() const {return min_len_;}
+        bool get_extend_seeds() const {return extend_seeds_;}
+        int get_seed_stages() const {return seed_stages_;}
+        int get_split_length() const {return split_length_;}
+        //minimal seed length of a seeding stage, the last one uses min_len_
+        int get_stage_min_len(int stage) const {
+                return min_len_ << (seed_stages_ - 1 - stage);
+        }
+        int get_max_occ() const {return max_occ_;}
+        int get_min_quality() const {return min_quality_;}
+        Seeder get_seeder() const {return seeder_;}
         OutputMode get_output_mode() const {return output_mode_;}
         std::string getLogFilename() const;
         /**
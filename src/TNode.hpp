@@ -65,9 +65,9 @@ public:
         }
         //getters
         int get_id() const {return id_;}
-        std::vector<int> get_in_edges() const {return in_edges_;}
+        std::vector<int> const &get_in_edges() const {return in_edges_;}
         std::vector<int> get_rc_in_edges() const {return reverseEdges(out_edges_);}
-        std::vector<int> get_out_edges() const {return out_edges_;}
+        std::vector<int> const &get_out_edges() const {return out_edges_;}
         std::vector<int> get_rc_out_edges() const {return reverseEdges(in_edges_);}
         
         int size() const {return size_;};
@@ -0,0 +1,101 @@
+/*******************************************************************************
+ *   Copyright (C) 2014, 2015 Giles Miclotte (giles.miclotte@intec.ugent.be)   *
+ *   This file is part of Jabba                                                *
+ *                                                                             *
+ *   This program is free software; you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published by      *
+ *   the Free Software Foundation; either version 2 of the License, or         *
+ *   (at your option) any later version.                                       *
+ *                                                                             *
+ *   This program is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *   GNU General Public License for more details.                              *
+ *                                                                             *
+ *   You should have received a copy of the GNU General Public License         *
+ *   along with this program; if not, write to the                             *
+ *   Free Software Foundation, Inc.,                                           *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.                 *
+ *******************************************************************************/
+#include "WindowPool.hpp"
+#include "Numa.hpp"
+
+#include <algorithm>
+
+WindowPool::WindowPool(size_t num_helpers, bool numa) : stop_(false)
+{
+        for (size_t i = 0; i < num_helpers; i++) {
+                helpers_.push_back(std::thread(&WindowPool::helperThread, this));
+                if (numa)
+                        Numa::pin(helpers_.back(), Numa::get_worker_cpu(i + 1));
+        }
+}
+
+WindowPool::~WindowPool()
+{
+        {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stop_ = true;
+        }
+        work_.notify_all();
+        for (auto& helper : helpers_)
+                helper.join();
+}
+
+bool WindowPool::takeWindow(Job *&job, size_t &window)
+{
+        while (!jobs_.empty()) {
+                job = jobs_.front();
+                if (job->next < job->num_windows) {
+                        window = job->next++;
+                        return true;
+                }
+                jobs_.pop_front();
+        }
+        return false;
+}
+
+void WindowPool::helperThread()
+{
+        CorrectionContext context;
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+                Job *job;
+                size_t window;
+                if (!takeWindow(job, window)) {
+                        if (stop_)
+                                return;
+                        work_.wait(lock);
+                        continue;
+                }
+                lock.unlock();
+                (*job->align)(window, context);
+                lock.lock();
+                // the job lives on the stack of its worker, which returns
+                // as soon as the last window is counted
+                if (++job->done == job->num_windows)
+                        finished_.notify_all();
+        }
+}
+
+void WindowPool::alignWindows(size_t num_windows, AlignFunction const &align,
+                              CorrectionContext &context)
+{
+        Job job = { num_windows, 0, 0, &align };
+        std::unique_lock<std::mutex> lock(mutex_);
+        jobs_.push_back(&job);
+        work_.notify_all();
+        while (job.next < job.num_windows) {
+                size_t window = job.next++;
+                lock.unlock();
+                align(window, context);
+                lock.lock();
+                job.done++;
+        }
+
+        // the helpers drop exhausted jobs from the front only
+        auto it = std::find(jobs_.begin(), jobs_.end(), &job);
+        if (it != jobs_.end())
+                jobs_.erase(it);
+        finished_.wait(lock, [&job]() { return job.done == job.num_windows; });
+}
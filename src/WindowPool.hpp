@@ -0,0 +1,102 @@
+/*******************************************************************************
+ *   Copyright (C) 2014, 2015 Giles Miclotte (giles.miclotte@intec.ugent.be)   *
+ *   This file is part of Jabba                                                *
+ *                                                                             *
+ *   This program is free software; you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published by      *
+ *   the Free Software Foundation; either version 2 of the License, or         *
+ *   (at your option) any later version.                                       *
+ *                                                                             *
+ *   This program is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *   GNU General Public License for more details.                              *
+ *                                                                             *
+ *   You should have received a copy of the GNU General Public License         *
+ *   along with this program; if not, write to the                             *
+ *   Free Software Foundation, Inc.,                                           *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.                 *
+ *******************************************************************************/
+#ifndef WINDOWPOOL_HPP
+#define WINDOWPOOL_HPP
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <cstddef>
+
+#include "CorrectionContext.hpp"
+
+// ============================================================================
+// WINDOW POOL CLASS
+// ============================================================================
+
+/**
+ * Helper threads shared by all worker threads to align the windows of split
+ * reads. A worker hands the windows of a read to the pool and aligns windows
+ * itself until all of them are taken, so the number of window threads stays
+ * bounded by the number of helpers however many long reads are in flight.
+ */
+class WindowPool
+{
+public:
+        //aligns one window using the buffers of the calling thread
+        typedef std::function<void(size_t, CorrectionContext&)> AlignFunction;
+
+private:
+        struct Job {
+                size_t num_windows;     //number of windows of the read
+                size_t next;            //next window to hand out
+                size_t done;            //number of aligned windows
+                AlignFunction const *align;
+        };
+
+        std::mutex mutex_;
+        std::condition_variable work_;          //a job was added or the pool stops
+        std::condition_variable finished_;      //the last window of a job was aligned
+        std::deque<Job*> jobs_;                 //jobs with windows left to hand out
+        bool stop_;
+        std::vector<std::thread> helpers_;
+
+        /**
+         * Entry routine for helper thread
+         */
+        void helperThread();
+
+        /**
+         * Take the next window of the front job, dropping jobs without
+         * windows left; the caller holds the lock
+         * @param job The job the window belongs to (output)
+         * @param window Index of the window (output)
+         * @return False if there are no windows to hand out
+         */
+        bool takeWindow(Job *&job, size_t &window);
+
+public:
+        /**
+         * Default constructor
+         * @param num_helpers Number of helper threads
+         * @param numa Pin the helpers to the CPUs of the worker threads
+         */
+        WindowPool(size_t num_helpers, bool numa);
+
+        /**
+         * Destructor, stops the helper threads
+         */
+        ~WindowPool();
+
+        /**
+         * Align the windows of a read on the calling thread and the helpers
+         * that are idle, returns when all windows are aligned
+         * @param num_windows Number of windows
+         * @param align Function that aligns one window
+         * @param context Buffers of the calling thread
+         */
+        void alignWindows(size_t num_windows, AlignFunction const &align,
+                          CorrectionContext &context);
+};
+
+#endif
@@ -25,6 +25,7 @@
 #include "readfile/rawfile.h"
 #include "readfile/sequencefile.h"
 #include "readfile/samfile.h"
+#include "Numa.hpp"
 
 #include <iostream>
 #include <algorithm>
@@ -611,6 +612,12 @@ void LibraryContainer::startIOThreads(size_t targetChunkSize_,
                 oThread = thread(&LibraryContainer::outputThreadEntry, this);
 }
 
+void LibraryContainer::pinIOThreads(int inputCPU, int outputCPU)
+{
+        Numa::pin(iThread, inputCPU);
+        Numa::pin(oThread, outputCPU);  // output thread might not be active
+}
+
 void LibraryContainer::joinIOThreads()
 {
         iThread.join();
@@ -417,6 +417,14 @@ public:
          */
         void joinIOThreads();
 
+        /**
+         * Pin the input and output thread to a CPU
+         * Call this after startIOThreads()
+         * @param inputCPU CPU identifier for the input thread
+         * @param outputCPU CPU identifier for the output thread
+         */
+        void pinIOThreads(int inputCPU, int outputCPU);
+
         /**
          * Read the metadata to disk
          * @param path Path to dir where the metadata should be read
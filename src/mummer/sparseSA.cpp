@@ -31,6 +31,7 @@ sparseSA::sparseSA(string &S_, vector<string> const &descr_, vector<long> &start
 	printRevCompForw = printRevCompForw_;
 	forward = true;
 	nucleotidesOnly = nucleotidesOnly_;
+	maxOcc = 0;
 
 	// Get maximum query sequence description length.
 	maxdescrlen = 0;
@@ -217,10 +218,22 @@ void sparseSA::computeKmer() {
 
 //TODO: add error handling and messages
 void sparseSA::save(const string &prefix) {
-	string basic = prefix;
-	string aux = basic + ".aux";
-	string sa = basic + ".sa";
-	string lcp = basic + ".lcp";
+	saveAux(prefix);
+	saveSA(prefix);
+	saveLCP(prefix);
+	//print ISA if nec
+	if (hasSufLink)
+		saveISA(prefix);
+	//print child if nec
+	if (hasChild)
+		saveCHILD(prefix);
+	//print kmer if nec
+	if (hasKmer)
+		saveKMR(prefix);
+}
+
+void sparseSA::saveAux(const string &prefix) {
+	string aux = prefix + ".aux";
 	ofstream aux_s (aux.c_str(), ios::binary);
 	//print auxiliary information
 	aux_s.write((const char*)&N,sizeof(N));
@@ -232,13 +245,19 @@ void sparseSA::save(const string &prefix) {
 	aux_s.write((const char*)&hasKmer,sizeof(hasKmer));
 	aux_s.write((const char*)&kMerSize,sizeof(kMerSize));
 	aux_s.close();
-	//print sa
+}
+
+void sparseSA::saveSA(const string &prefix) {
+	string sa = prefix + ".sa";
 	ofstream sa_s (sa.c_str(), ios::binary);
 	unsigned int sizeSA = SA.size();
 	sa_s.write((const char*)&sizeSA,sizeof(sizeSA));
 	sa_s.write((const char*)&SA[0],sizeSA*sizeof(unsigned int));
 	sa_s.close();
-	//print LCP
+}
+
+void sparseSA::saveLCP(const string &prefix) {
+	string lcp = prefix + ".lcp";
 	ofstream lcp_s (lcp.c_str(), ios::binary);
 	unsigned int sizeLCP = LCP.vec.size();
 	unsigned int sizeM = LCP.M.size();
@@ -247,40 +266,39 @@ void sparseSA::save(const string &prefix) {
 	lcp_s.write((const char*)&LCP.vec[0],sizeLCP*sizeof(unsigned char));
 	lcp_s.write((const char*)&LCP.M[0],sizeM*sizeof(vec_uchar::item_t));
 	lcp_s.close();
-	//print ISA if nec
-	if (hasSufLink) {
-		string isa = basic + ".isa";
-		ofstream isa_s (isa.c_str(), ios::binary);
-		unsigned int sizeISA = ISA.size();
-		isa_s.write((const char*)&sizeISA,sizeof(sizeISA));
-		isa_s.write((const char*)&ISA[0],sizeISA*sizeof(int));
-		isa_s.close();
-	}
-	//print child if nec
-	if (hasChild) {
-		string child = basic + ".child";
-		ofstream child_s (child.c_str(), ios::binary);
-		unsigned int sizeCHILD = CHILD.size();
-		child_s.write((const char*)&sizeCHILD,sizeof(sizeCHILD));
-		child_s.write((const char*)&CHILD[0],sizeCHILD*sizeof(int));
-		child_s.close();
-	}
-	//print kmer if nec
-	if (hasKmer) {
-		string kmer = basic + ".kmer";
-		ofstream kmer_s (kmer.c_str(), ios::binary);
-		unsigned int sizeKMR = KMR.size();
-		kmer_s.write((const char*)&sizeKMR,sizeof(sizeKMR));
-		kmer_s.write((const char*)&KMR[0],sizeKMR*sizeof(saTuple_t));
-		kmer_s.close();
-	}
+}
+
+void sparseSA::saveISA(const string &prefix) {
+	string isa = prefix + ".isa";
+	ofstream isa_s (isa.c_str(), ios::binary);
+	unsigned int sizeISA = ISA.size();
+	isa_s.write((const char*)&sizeISA,sizeof(sizeISA));
+	isa_s.write((const char*)&ISA[0],sizeISA*sizeof(int));
+	isa_s.close();
+}
+
+void sparseSA::saveCHILD(const string &prefix) {
+	string child = prefix + ".child";
+	ofstream child_s (child.c_str(), ios::binary);
+	unsigned int sizeCHILD = CHILD.size();
+	child_s.write((const char*)&sizeCHILD,sizeof(sizeCHILD));
+	child_s.write((const char*)&CHILD[0],sizeCHILD*sizeof(int));
+	child_s.close();
+}
+
+void sparseSA::saveKMR(const string &prefix) {
+	string kmer = prefix + ".kmer";
+	ofstream kmer_s (kmer.c_str(), ios::binary);
+	unsigned int sizeKMR = KMR.size();
+	kmer_s.write((const char*)&sizeKMR,sizeof(sizeKMR));
+	kmer_s.write((const char*)&KMR[0],sizeKMR*sizeof(saTuple_t));
+	kmer_s.close();
 }
 
 bool sparseSA::load(const string &prefix) {
 	cerr << "atempting to load index " << prefix << " ... "<< endl;
 	string basic = prefix;
 	string aux = basic + ".aux";
-	string sa = basic + ".sa";
 	string lcp = basic + ".lcp";
 	ifstream aux_s (aux.c_str(), ios::binary);
 	if (!aux_s.good()) {
@@ -300,12 +318,7 @@ bool sparseSA::load(const string &prefix) {
 	aux_s.read((char*)&kMerSize,sizeof(kMerSize));
 	aux_s.close();
 	//read sa
-	ifstream sa_s (sa.c_str(), ios::binary);
-	unsigned int sizeSA;
-	sa_s.read((char*)&sizeSA,sizeof(sizeSA));
-	SA.resize(sizeSA);
-	sa_s.read((char*)&SA[0],sizeSA*sizeof(unsigned int));
-	sa_s.close();
+	loadSA(prefix);
 	//read LCP
 	ifstream lcp_s (lcp.c_str(), ios::binary);
 	unsigned int sizeLCP;
@@ -352,7 +365,17 @@ bool sparseSA::load(const string &prefix) {
 	return true;
 }
 
-void sparseSA::construct() {
+void sparseSA::loadSA(const string &prefix) {
+	string sa = prefix + ".sa";
+	ifstream sa_s (sa.c_str(), ios::binary);
+	unsigned int sizeSA;
+	sa_s.read((char*)&sizeSA,sizeof(sizeSA));
+	SA.resize(sizeSA);
+	sa_s.read((char*)&SA[0],sizeSA*sizeof(unsigned int));
+	sa_s.close();
+}
+
+void sparseSA::constructSA() {
 	cerr << "N=" << N << endl;
 	cerr << "N/K=" << N/K << endl;
 	if (K > 1) {
@@ -409,13 +432,17 @@ void sparseSA::construct() {
 		int *SAint = (int*)(&SA[0]);
 		suffixsort(&ISA[0], SAint , N-1, alphalast, 1);
 	}
+}
+
+void sparseSA::construct() {
+	constructSA();
 	LCP.resize(N/K);
 	// Use algorithm by Kasai et al to construct LCP array.
 	computeLCP();	// SA + ISA -> LCP
 	LCP.init();
 	if (!hasSufLink) {
 		{
-			vector<int> tmp;
+			intvec_t tmp;
 			ISA.swap(tmp);
 		}
 	//ISA.clear();
@@ -437,6 +464,71 @@ void sparseSA::construct() {
 
 }
 
+void sparseSA::construct(const string &prefix) {
+	constructSA();
+	LCP.resize(N/K);
+	// Use algorithm by Kasai et al to construct LCP array.
+	computeLCP();	// SA + ISA -> LCP
+	LCP.init();
+	NKm1 = N/K-1;
+	saveAux(prefix);
+	saveLCP(prefix);
+	// ISA and SA are not needed to build the CHILD array.
+	if (hasSufLink)
+		saveISA(prefix);
+	intvec_t().swap(ISA);
+	saveSA(prefix);
+	uintvec_t().swap(SA);
+	if (hasChild) {
+		CHILD.resize(N/K);
+		//Use algorithm by Abouelhoda et al to construct CHILD array
+		computeChild();
+		saveCHILD(prefix);
+		intvec_t().swap(CHILD);
+	}
+	if (hasKmer) {
+		// Without the CHILD array the k-mer table is built by binary
+		// search over SA, which yields the same intervals.
+		loadSA(prefix);
+		kMerTableSize = 1 << (2*kMerSize);
+		cerr << "kmer table size: " << kMerTableSize << endl;
+		KMR.resize(kMerTableSize, saTuple_t());
+		bool child = hasChild;
+		hasChild = false;
+		computeKmer();
+		hasChild = child;
+		saveKMR(prefix);
+		vector<saTuple_t, HugePageAllocator<saTuple_t> >().swap(KMR);
+		uintvec_t().swap(SA);
+	}
+	ucharvec_t().swap(LCP.vec);
+	vector<vec_uchar::item_t>().swap(LCP.M);
+}
+
+long sparseSA::construction_peak_bytes(long N, long K, bool suflink, bool child,
+	bool kmer, long kMerSize, bool staged) {
+	long NK = N/K + 1;
+	long kmr = kmer ? (1L << (2*kMerSize)) * (long)sizeof(saTuple_t) : 0L;
+	// suffix sorting: two integer arrays
+	long peak = 2 * NK * (long)sizeof(int);
+	// LCP computation: SA, ISA and LCP
+	long lcp = NK * (long)(sizeof(unsigned int) + sizeof(int) + sizeof(unsigned char));
+	peak = max(peak, lcp);
+	if (staged) {
+		// CHILD computation from LCP only, k-mer table from SA only
+		if (child)
+			peak = max(peak, NK * (long)(sizeof(int) + sizeof(unsigned char)));
+		if (kmer)
+			peak = max(peak, NK * (long)sizeof(unsigned int) + kmr);
+	} else {
+		// all arrays are kept until the index is saved
+		if (!suflink)
+			lcp -= NK * (long)sizeof(int);
+		peak = max(peak, lcp + (child ? NK * (long)sizeof(int) : 0L) + kmr);
+	}
+	return peak;
+}
+
 // Implements a variant of American flag sort (McIlroy radix sort).
 // Recurse until big-K size prefixes are sorted. Adapted from the C++
 // source code for the wordSA implementation from the following paper:
@@ -555,6 +647,13 @@ void sparseSA::traverse(string const &P, long const prefix, interval_t &cur, int
 	}
 	if (cur.depth >= min_len) return;
 	while (prefix+cur.depth < (long)P.length()) {
+		if (cur.start == cur.end) {
+			// A single suffix is left, compare it word by word.
+			long n = min((long)P.length() - prefix - cur.depth, (long)min_len - cur.depth);
+			n = min(n, (long)S.length() - SA[cur.start] - cur.depth);
+			if (n > 0) cur.depth += common_prefix(S.data() + SA[cur.start] + cur.depth, P.data() + prefix + cur.depth, n);
+			return;
+		}
 		long start = cur.start; long end = cur.end;
 		// If we reach a mismatch, stop.
 		if (top_down_faster(P[prefix+cur.depth], cur.depth, start, end) == false) return;
@@ -610,19 +709,24 @@ void sparseSA::traverse_faster(string const &P, long const prefix, interval_t &c
 				childLCP = LCP[CHILD[cur.start]];
 			int minimum = min(childLCP,min_len);
 			//match along branch
-			while (!mismatchFound && c < P.length() && cur.depth < minimum) {
-				mismatchFound = S[SA[cur.start]+cur.depth] != P[c];
-				c++;
-				cur.depth += !mismatchFound;
+			long n = min((long)P.length() - c, (long)minimum - cur.depth);
+			if (n > 0) {
+				long l = common_prefix(S.data() + SA[cur.start] + cur.depth, P.data() + c, n);
+				mismatchFound = l < n;
+				c += l + mismatchFound;
+				cur.depth += l;
 			}
 			intervalFound = c < P.length() && !mismatchFound &&
 					cur.depth < min_len && top_down_child(P[c], cur);
 		} else {
-			while (!mismatchFound && c < P.length() && cur.depth < min_len) {
-				mismatchFound = SA[cur.start]+cur.depth >= S.length() ||
-						S[SA[cur.start]+cur.depth] != P[c];
-				c++;
-				cur.depth += !mismatchFound;
+			//extend the single suffix, the end of S is a mismatch
+			long n = min((long)P.length() - c, (long)min_len - cur.depth);
+			if (n > 0) {
+				long avail = (long)S.length() - SA[cur.start] - cur.depth;
+				long l = avail <= 0 ? 0 : common_prefix(S.data() + SA[cur.start] + cur.depth, P.data() + c, min(n, avail));
+				mismatchFound = l < n;
+				c += l + mismatchFound;
+				cur.depth += l;
 			}
 		}
 	}
@@ -726,90 +830,172 @@ bool sparseSA::suffixlink(interval_t &m) const {
 	return expand_link(m);
 }
 
+// Stores the MEMs in a vector, or prints them buffered through it.
+struct match_collector_t : mem_visitor_t {
+	match_collector_t(sparseSA const &sa_, vector<match_t> &matches_, bool print_) :
+		sa(sa_), matches(matches_), print(print_) {}
+	void visit(match_t const &m) {
+		if (print) sa.print_match(m, matches);
+		else matches.push_back(m);
+	}
+	sparseSA const &sa;
+	vector<match_t> &matches;
+	bool print;
+};
+
 // For a given offset in the prefix k, find all MEMs.
 void sparseSA::findMEM(long const k, string const &P, vector<match_t> &matches, int const min_len, bool const print) const {
+	match_collector_t collector(*this, matches, print);
+	findMEM(k, P, collector, min_len);
+	if (print) print_match(match_t(), matches);	 // Clear buffered matches.
+}
+
+void sparseSA::findMEM(long const k, string const &P, mem_visitor_t &visitor, int const min_len, vector<bool> const *skip) const {
 	if (k < 0 || k >= K) { cerr << "Invalid k." << endl; return; }
+	mem_state_t state;
+	findMEMInit(k, P, visitor, state, skip);
+	while (findMEMStep(state, min_len)) {}
+}
+
+void sparseSA::findMEMInit(long const k, string const &P, mem_visitor_t &visitor, mem_state_t &state, vector<bool> const *skip) const {
+	state.P = &P;
+	state.visitor = &visitor;
+	state.skip = skip;
 	// Offset all intervals at different start points.
-	long prefix = k;
-	interval_t mli(0,N/K-1,0); // min length interval
-	interval_t xmi(0,N/K-1,0); // max match interval
+	state.prefix = k;
+	state.mli = interval_t(0,N/K-1,0);
+	state.xmi = interval_t(0,N/K-1,0);
+}
+
+bool sparseSA::findMEMStep(mem_state_t &state, int const min_len) const {
+	string const &P = *state.P;
+	long &prefix = state.prefix;
+	interval_t &mli = state.mli;
+	interval_t &xmi = state.xmi;
 
 	// Right-most match used to terminate search.
 	int min_lenK = min_len - (sparseMult*K-1);
 
-	while ( prefix <= (long)P.length() - min_lenK) {//BUGFIX: used to be "prefix <= (long)P.length() - (K-k0)"
-#ifndef NDEBUG
-//			interval_t mliCopy(mli.start,mli.end,mli.depth);
-//			traverse(P, prefix, mliCopy, min_lenK);		// Traverse until minimum length matched.
-#endif
+	if (prefix > (long)P.length() - min_lenK) return false;//BUGFIX: used to be "prefix <= (long)P.length() - (K-k0)"
+	if (state.skip != NULL && (*state.skip)[prefix]) {
+		// Skipped offsets lose the suffix link state, restart at the root.
+		mli.reset(N/K-1); xmi.reset(N/K-1); prefix+=sparseMult*K; return true;
+	}
+	if (hasChild)
+		traverse_faster(P, prefix, mli, min_lenK);		// Traverse until minimum length matched.
+	else
+		traverse(P, prefix, mli, min_lenK);		// Traverse until minimum length matched.
+	if (mli.depth > xmi.depth) xmi = mli;
+	if (mli.depth <= 1) { mli.reset(N/K-1); xmi.reset(N/K-1); prefix+=sparseMult*K; return true; }
+
+	if (mli.depth >= min_lenK) {
 		if (hasChild)
-				traverse_faster(P, prefix, mli, min_lenK);		// Traverse until minimum length matched.
+			traverse_faster(P, prefix, xmi, P.length()); // Traverse until mismatch.
 		else
-				traverse(P, prefix, mli, min_lenK);		// Traverse until minimum length matched.
-#ifndef NDEBUG
-//			assert(mli.start == mliCopy.start);
-//			assert(mli.end == mliCopy.end);
-//			assert(mli.depth == mliCopy.depth);
-#endif
-		if (mli.depth > xmi.depth) xmi = mli;
-		if (mli.depth <= 1) { mli.reset(N/K-1); xmi.reset(N/K-1); prefix+=sparseMult*K; continue; }
-
-		if (mli.depth >= min_lenK) {
-#ifndef NDEBUG
-//			interval_t xmiCopy(xmi.start,xmi.end,xmi.depth);
-//			traverse(P, prefix, xmiCopy, P.length());		// Traverse until mismatch.
-#endif
-			if (hasChild)
-				traverse_faster(P, prefix, xmi, P.length()); // Traverse until mismatch.
-			else
-				traverse(P, prefix, xmi, P.length()); // Traverse until mismatch.
-#ifndef NDEBUG
-//			assert(xmi.start == xmiCopy.start);
-//			assert(xmi.end == xmiCopy.end);
-//			assert(xmi.depth == xmiCopy.depth);
-#endif
-			collectMEMs(P, prefix, mli, xmi, matches, min_len, print); // Using LCP info to find MEM length.
-			// When using ISA/LCP trick, depth = depth - K. prefix += K.
-			prefix+=sparseMult*K;
-			if ( !hasSufLink ) { mli.reset(N/K-1); xmi.reset(N/K-1); continue; }
-			else {
-					int i = 0;
-					bool succes	= true;
-					while (i < sparseMult && (succes = suffixlink(mli))) {
-							suffixlink(xmi);
-							i++;
-					}
-					if (!succes) {
-							mli.reset(N/K-1); xmi.reset(N/K-1); continue;
-					}
-			}
+			traverse(P, prefix, xmi, P.length()); // Traverse until mismatch.
+		collectMEMs(P, prefix, mli, xmi, *state.visitor, min_len); // Using LCP info to find MEM length.
+		// When using ISA/LCP trick, depth = depth - K. prefix += K.
+		prefix+=sparseMult*K;
+		if ( !hasSufLink ) { mli.reset(N/K-1); xmi.reset(N/K-1); return true; }
+		else {
+				int i = 0;
+				bool succes	= true;
+				while (i < sparseMult && (succes = suffixlink(mli))) {
+						suffixlink(xmi);
+						i++;
+				}
+				if (!succes) {
+						mli.reset(N/K-1); xmi.reset(N/K-1); return true;
+				}
 		}
+	}
+	else {
+		// When using ISA/LCP trick, depth = depth - K. prefix += K.
+		prefix+=sparseMult*K;
+		if ( !hasSufLink) { mli.reset(N/K-1); xmi.reset(N/K-1); return true; }
 		else {
-			// When using ISA/LCP trick, depth = depth - K. prefix += K.
-			prefix+=sparseMult*K;
-			if ( !hasSufLink) { mli.reset(N/K-1); xmi.reset(N/K-1); continue; }
-			else {
-					int i = 0;
-					bool succes	= true;
-					while (i < sparseMult && (succes = suffixlink(mli))) {
-							i++;
-					}
-					if (!succes) {
-							mli.reset(N/K-1); xmi.reset(N/K-1); continue;
-					}
-					xmi = mli;
+				int i = 0;
+				bool succes	= true;
+				while (i < sparseMult && (succes = suffixlink(mli))) {
+						i++;
+				}
+				if (!succes) {
+						mli.reset(N/K-1); xmi.reset(N/K-1); return true;
+				}
+				xmi = mli;
+		}
+	}
+	return true;
+}
+
+// The next traversal starts with a k-mer table lookup from the root, or
+// with the child table, LCP and SA entries of the current interval.
+void sparseSA::prefetch(mem_state_t const &state, int const min_len) const {
+	interval_t const &mli = state.mli;
+	string const &P = *state.P;
+	if (mli.depth == 0) {
+		if (hasKmer && min_len - (sparseMult*K-1) >= kMerSize
+			&& state.prefix + kMerSize <= (long)P.length()) {
+			unsigned int index = 0;
+			for (long i = 0; i < kMerSize; i++)
+				index = (index << 2) | BITADD[(unsigned char)P[state.prefix + i]];
+			if (index < kMerTableSize) __builtin_prefetch(&KMR[index]);
+		}
+		return;
+	}
+	__builtin_prefetch(&SA[mli.start]);
+	__builtin_prefetch(&LCP.vec[mli.start]);
+	if (hasChild) {
+		__builtin_prefetch(&CHILD[mli.start]);
+		__builtin_prefetch(&CHILD[mli.end]);
+	}
+}
+
+// Keeps a window of searches in flight. Each search advances by one
+// offset, then prefetches its next interval while the others run.
+void sparseSA::findMEMBatch(vector<string const *> const &P, vector<vector<bool> const *> const &skips, vector<mem_visitor_t *> const &visitors, int const min_len) const {
+	static const size_t window = 16;
+	vector<mem_state_t> active;
+	active.reserve(window);
+	size_t next = 0;
+	while (next < P.size() || !active.empty()) {
+		while (active.size() < window && next < P.size()) {
+			active.push_back(mem_state_t());
+			findMEMInit(0, *P[next], *visitors[next], active.back(), skips[next]);
+			++next;
+		}
+		for (size_t i = 0; i < active.size(); ) {
+			if (findMEMStep(active[i], min_len)) {
+				prefetch(active[i], min_len);
+				++i;
+			} else {
+				active[i] = active.back();
+				active.pop_back();
 			}
 		}
 	}
-	if (print) print_match(match_t(), matches);	 // Clear buffered matches.
 }
 
 
 // Use LCP information to locate right maximal matches. Test each for
-// left maximality.
-void sparseSA::collectMEMs(string const &P, long prefix, interval_t mli, interval_t xmi, vector<match_t> &matches, int const min_len, bool const print) const {
+// left maximality. When mli holds more than maxOcc suffixes, only every
+// stride-th suffix of mli is visited. Its match length is found by
+// comparing it with P beyond the depth of mli, so the interval is not
+// walked and repeats yield at most maxOcc matches.
+void sparseSA::collectMEMs(string const &P, long prefix, interval_t mli, interval_t xmi, mem_visitor_t &visitor, int const min_len) const {
+	long occ = mli.size();
+	if (maxOcc > 0 && occ > maxOcc) {
+		long stride = (occ + maxOcc - 1) / maxOcc;
+		for (long i = mli.start; i <= mli.end; i += stride) {
+			long n = min(xmi.depth, N - (long)SA[i]) - mli.depth;
+			long len = mli.depth;
+			if (n > 0) len += common_prefix(S.data() + SA[i] + len, P.data() + prefix + len, n);
+			find_Lmaximal(P, prefix, SA[i], len, occ, visitor, min_len);
+		}
+		return;
+	}
 	// All of the suffixes in xmi's interval are right maximal.
-	for (long i = xmi.start; i <= xmi.end; i++) find_Lmaximal(P, prefix, SA[i], xmi.depth, matches, min_len, print);
+	for (long i = xmi.start; i <= xmi.end; i++) find_Lmaximal(P, prefix, SA[i], xmi.depth, occ, visitor, min_len);
 
 	if (mli.start == xmi.start && mli.end == xmi.end) return;
 
@@ -823,12 +1009,12 @@ void sparseSA::collectMEMs(string const &P, long prefix, interval_t mli, interva
 			// Scan RMEMs to the left, check their left maximality..
 			while (LCP[xmi.start] >= xmi.depth) {
 	xmi.start--;
-	find_Lmaximal(P, prefix, SA[xmi.start], xmi.depth, matches, min_len, print);
+	find_Lmaximal(P, prefix, SA[xmi.start], xmi.depth, occ, visitor, min_len);
 			}
 			// Find RMEMs to the right, check their left maximality.
 			while (xmi.end+1 < N/K && LCP[xmi.end+1] >= xmi.depth) {
 	xmi.end++;
-	find_Lmaximal(P, prefix, SA[xmi.end], xmi.depth, matches, min_len, print);
+	find_Lmaximal(P, prefix, SA[xmi.end], xmi.depth, occ, visitor, min_len);
 			}
 		}
 	}
@@ -836,27 +1022,17 @@ void sparseSA::collectMEMs(string const &P, long prefix, interval_t mli, interva
 
 
 // Finds left maximal matches given a right maximal match at position i.
-void sparseSA::find_Lmaximal(string const &P, long prefix, long i, long len, vector<match_t> &matches, int const min_len, bool const print) const {
+void sparseSA::find_Lmaximal(string const &P, long prefix, long i, long len, long occ, mem_visitor_t &visitor, int const min_len) const {
 	long Plength = P.length();
-	// Advance to the left up to K steps.
-	for (long k = 0; k < sparseMult*K; k++) {
-		// If we reach the end and the match is long enough, print.
-		if (prefix == 0 || i == 0) {
-			if (len >= min_len) {
-	if (print) print_match(match_t(i, (!printRevCompForw || forward) ? prefix : Plength-1-prefix, len), matches);
-	else matches.push_back(match_t(i, (!printRevCompForw || forward) ? prefix : Plength-1-prefix, len));
-			}
-			return; // Reached mismatch, done.
-		}
-		else if (P[prefix-1] != S[i-1]) {
-			// If we reached a mismatch, print the match if it is long enough.
-			if (len >= min_len) {
-	if (print) print_match(match_t(i, (!printRevCompForw || forward) ? prefix : Plength-1-prefix, len), matches);
-	else matches.push_back(match_t(i, (!printRevCompForw || forward) ? prefix : Plength-1-prefix, len));
-			}
-			return; // Reached mismatch, done.
-		}
-		prefix--; i--; len++; // Continue matching.
+	// Advance to the left up to K steps, stopping at a mismatch or at the
+	// start of P or S.
+	long steps = sparseMult*K;
+	long l = common_suffix(P.data() + prefix, S.data() + i, min(steps, min(prefix, i)));
+	// Matches that extend K steps are found from another sparse suffix.
+	if (l == steps) return;
+	prefix -= l; i -= l; len += l;
+	if (len >= min_len) {
+		visitor.visit(match_t(i, (!printRevCompForw || forward) ? prefix : Plength-1-prefix, len, occ));
 	}
 }
 
@@ -7,7 +7,10 @@
 #include <algorithm>
 #include <limits>
 #include <limits.h>
+#include <stdint.h>
+#include <string.h>
 
+#include "../HugePages.hpp"
 
 using namespace std;
 
@@ -40,6 +43,44 @@ static const unsigned int BITADD[256] = {
 	UINT_MAX, UINT_MAX, UINT_MAX, UINT_MAX, UINT_MAX, UINT_MAX                                         //250-255
 };
 
+// Number of equal characters at the start of a and b, at most n. Compares
+// eight characters per step, the first differing byte of a word is found
+// by counting the trailing zeros of the xor.
+static inline long common_prefix(const char *a, const char *b, long n) {
+	long l = 0;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	for (; l + 8 <= n; l += 8) {
+		uint64_t x, y;
+		memcpy(&x, a + l, 8);
+		memcpy(&y, b + l, 8);
+		if (x != y) return l + (__builtin_ctzll(x ^ y) >> 3);
+	}
+#endif
+	while (l < n && a[l] == b[l]) l++;
+	return l;
+}
+
+// Number of equal characters right before a and b, at most n. The last
+// differing byte of a word is found by counting the leading zeros.
+static inline long common_suffix(const char *a, const char *b, long n) {
+	long l = 0;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	for (; l + 8 <= n; l += 8) {
+		uint64_t x, y;
+		memcpy(&x, a - l - 8, 8);
+		memcpy(&y, b - l - 8, 8);
+		if (x != y) return l + (__builtin_clzll(x ^ y) >> 3);
+	}
+#endif
+	while (l < n && a[-l-1] == b[-l-1]) l++;
+	return l;
+}
+
+// Index arrays, backed by huge pages when enabled.
+typedef vector<unsigned int, HugePageAllocator<unsigned int> > uintvec_t;
+typedef vector<int, HugePageAllocator<int> > intvec_t;
+typedef vector<unsigned char, HugePageAllocator<unsigned char> > ucharvec_t;
+
 // Stores the LCP array in an unsigned char (0-255). Values larger
 // than or equal to 255 are stored in a sorted array.
 // Simulates a vector<int> LCP;
@@ -50,7 +91,7 @@ struct vec_uchar {
 		size_t idx; int val;
 		bool operator < (item_t const t) const { return idx < t.idx; }
 	};
-	vector<unsigned char> vec;  // LCP values from 0-65534
+	ucharvec_t vec;  // LCP values from 0-65534
 	vector<item_t> M;
 	void resize(size_t const N) { vec.resize(N); }
 	// Vector X[i] notation to get LCP values.
@@ -84,11 +125,13 @@ struct vec_uchar {
 
 // Match find by findMEM.
 struct match_t {
-	match_t() { ref = 0; query = 0, len = 0; }
-	match_t(long r, long q, long l) { ref = r; query = q; len = l; }
+	match_t() { ref = 0; query = 0, len = 0; occ = 1; }
+	match_t(long r, long q, long l, long o = 1) { ref = r; query = q; len = l; occ = o; }
 	long ref;  // position in reference sequence
 	long query;  // position in query
 	long len;  // length of match
+	long occ;  // size of the index interval the match was found in, at
+	           // least the number of occurrences reported for it
 };
 
 struct saTuple_t {
@@ -107,6 +150,22 @@ struct interval_t {
 	long size() { return end - start + 1; }
 };
 
+// Receives the MEMs of findMEM one at a time, as they are found.
+struct mem_visitor_t {
+	virtual ~mem_visitor_t() {}
+	virtual void visit(match_t const &m) = 0;
+};
+
+// Search state of one query in findMEM, advanced one offset at a time.
+struct mem_state_t {
+	string const *P;  // query
+	mem_visitor_t *visitor;  // receives the MEMs
+	long prefix;  // offset in the query
+	vector<bool> const *skip;  // offsets not to search from, or NULL
+	interval_t mli;  // min length interval
+	interval_t xmi;  // max match interval
+};
+
 struct sparseSA {
 	vector<string> const &descr;  // Descriptions of concatenated sequences.
 	vector<long> const &startpos;  // Lengths of concatenated sequences.
@@ -117,11 +176,11 @@ struct sparseSA {
 	long logN;  // ceil(log(N))
 	long NKm1;  // N/K - 1
 	string &S;  //!< Reference to sequence data.
-	vector<unsigned int> SA;  // Suffix array.
-	vector<int> ISA;  // Inverse suffix array.
+	uintvec_t SA;  // Suffix array.
+	intvec_t ISA;  // Inverse suffix array.
 	vec_uchar LCP;  // Simulates a vector<int> LCP.
-	vector<int> CHILD;  // child table
-	vector<saTuple_t> KMR;
+	intvec_t CHILD;  // child table
+	vector<saTuple_t, HugePageAllocator<saTuple_t> > KMR;
 
 	long K;  // suffix sampling, K = 1 every suffix, K = 2 every other suffix, K = 3, every 3rd sffix
 	bool hasChild;
@@ -135,8 +194,9 @@ struct sparseSA {
 	bool printRevCompForw;
 	bool forward;
 	bool nucleotidesOnly;
+	long maxOcc;  // Maximum number of occurrences reported per MEM, 0 = all.
 
-	long index_size_in_bytes() {
+	long index_size_in_bytes() const {
 		long indexSize = 0L;
 		indexSize += sizeof(forward);
 		indexSize += sizeof(printRevCompForw);
@@ -240,14 +300,28 @@ struct sparseSA {
 
 	// Given a position i in S, finds a left maximal match of minimum
 	// length within K steps.
-	inline void find_Lmaximal(string const &P, long prefix, long i, long len, vector<match_t> &matches, int const min_len, bool const print) const;
+	inline void find_Lmaximal(string const &P, long prefix, long i, long len, long occ, mem_visitor_t &visitor, int const min_len) const;
 
 	// Given an interval where the given prefix is matched up to a
 	// mismatch, find all MEMs up to a minimum match depth.
-	void collectMEMs(string const &P, long prefix, interval_t mli, interval_t xmi, vector<match_t> &matches, int const min_len, bool const print) const;
+	void collectMEMs(string const &P, long prefix, interval_t mli, interval_t xmi, mem_visitor_t &visitor, int const min_len) const;
 
 	// Find all MEMs given a prefix pattern offset k.
 	void findMEM(long const k, string const &P, vector<match_t> &matches, int const min_len, bool const print) const;
+	// Find all MEMs given a prefix pattern offset k, streamed to visitor.
+	// Offsets marked in skip are not searched from, so no MEMs starting there are found.
+	void findMEM(long const k, string const &P, mem_visitor_t &visitor, int const min_len, vector<bool> const *skip = NULL) const;
+
+	// Start the search of findMEM for prefix offset k.
+	void findMEMInit(long const k, string const &P, mem_visitor_t &visitor, mem_state_t &state, vector<bool> const *skip = NULL) const;
+	// Search one offset of the query, returns false once the query is done.
+	bool findMEMStep(mem_state_t &state, int const min_len) const;
+	// Prefetch what the next step of a search touches first.
+	inline void prefetch(mem_state_t const &state, int const min_len) const;
+	// Find all MEMs of many queries, interleaving the searches so that
+	// their cache misses overlap. Query i streams its MEMs to visitors[i],
+	// in the same order as findMEM(0).
+	void findMEMBatch(vector<string const *> const &P, vector<vector<bool> const *> const &skips, vector<mem_visitor_t *> const &visitors, int const min_len) const;
 
 	// NOTE: min_len must be > 1
 	void findMAM(string const &P, vector<match_t> &matches, int const min_len, long& memCount, bool const print) const;
@@ -272,12 +346,34 @@ struct sparseSA {
 
 	// save index to files
 	void save(const string &prefix);
+	// save the individual index files
+	void saveAux(const string &prefix);
+	void saveSA(const string &prefix);
+	void saveLCP(const string &prefix);
+	void saveISA(const string &prefix);
+	void saveCHILD(const string &prefix);
+	void saveKMR(const string &prefix);
 
 	// load index from file
 	bool load(const string &prefix);
+	// load the suffix array file only
+	void loadSA(const string &prefix);
 
 	// construct
 	void construct();
+	// construct the index straight into the index files with the given
+	// prefix, releasing every array as soon as the later stages no longer
+	// need it; call load() afterwards to use the index
+	void construct(const string &prefix);
+
+	// Peak number of bytes needed to construct an index over a text of
+	// length N (excluding the text itself). With staged set, the peak of
+	// construct(prefix) is returned, otherwise that of construct().
+	static long construction_peak_bytes(long N, long K, bool suflink, bool child,
+		bool kmer, long kMerSize, bool staged);
+private:
+	// Build SA (and ISA) from S, shared by both construct() variants.
+	void constructSA();
 };
 
 
@@ -77,10 +77,10 @@ bool FastQFile::getNextRecord(ReadRecord& record)
                 record.postRead = '\n';
         }
 
-        record.qualityOff = record.postRead.size();
         // read the + line
         record.postRead.append(rfHandler->getLine());
         // read the quality scores
+        record.qualityOff = record.postRead.size();
         record.postRead.append(rfHandler->getLine());
 
         return !record.read.empty();
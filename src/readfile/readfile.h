@@ -49,13 +49,13 @@ public:
         /**
          * Default constructor
          */
-        ReadRecord() {}
+        ReadRecord() : qualityOff(std::string::npos) {}
 
         void clear() {
                 preRead.clear();
                 read.clear();
                 postRead.clear();
-                qualityOff = 0;
+                qualityOff = std::string::npos;
         }
 
         std::string getRead() const {
@@ -71,19 +71,28 @@ public:
         }
 
         std::string getQualityString() const {
-                if (qualityOff >= postRead.size())
+                if (qualityOff == std::string::npos ||
+                    qualityOff >= postRead.size())
                         return std::string();
 
                 return postRead.substr(qualityOff, read.size());
         }
 
+        const char* getQuality() const {
+                if (qualityOff == std::string::npos ||
+                    qualityOff + read.size() > postRead.size())
+                        return NULL;
+
+                return postRead.data() + qualityOff;
+        }
+
 //private:
         std::string preRead;    // everything in the record that precedes the read
         std::string read;       // read itself
         std::string postRead;   // everything in the record that procedes the read
         std::vector<std::string> correction; // read correction
 
-        size_t qualityOff;      // quality score offset within the record
+        size_t qualityOff;      // quality score offset within postRead, npos if none
 };
 
 // ============================================================================
@@ -74,6 +74,9 @@ bool SamFile::getNextRecord(ReadRecord& record)
         record.preRead.push_back('\t');
         oss >> record.read;
         record.postRead.append(result.substr(oss.tellg()));
+        // QUAL follows the read after a tab, '*' if it is absent
+        if (record.postRead.size() > 1 && record.postRead[1] != '*')
+                record.qualityOff = 1;
 
         return !record.read.empty();
 }
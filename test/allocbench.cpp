@@ -0,0 +1,200 @@
+/*******************************************************************************
+ *   Copyright (C) 2014, 2015 Giles Miclotte (giles.miclotte@intec.ugent.be)   *
+ *   This file is part of Jabba                                                *
+ *                                                                             *
+ *   This program is free software; you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published by      *
+ *   the Free Software Foundation; either version 2 of the License, or         *
+ *   (at your option) any later version.                                       *
+ *                                                                             *
+ *   This program is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *   GNU General Public License for more details.                              *
+ *                                                                             *
+ *   You should have received a copy of the GNU General Public License         *
+ *   along with this program; if not, write to the                             *
+ *   Free Software Foundation, Inc.,                                           *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.                 *
+ *******************************************************************************/
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "Graph.hpp"
+#include "ReadCorrectionHandler.hpp"
+#include "Settings.hpp"
+
+//allocations are counted while this is set
+static std::atomic<bool> counting(false);
+static std::atomic<long> allocations(0);
+
+void *operator new(std::size_t size) {
+        if (counting) {
+                ++allocations;
+        }
+        void *p = std::malloc(size == 0 ? 1 : size);
+        if (p == NULL) {
+                throw std::bad_alloc();
+        }
+        return p;
+}
+
+void operator delete(void *p) noexcept {
+        std::free(p);
+}
+
+//deterministic random sequences, the same on every platform
+static unsigned int state = 12345;
+static int nextRandom(int range) {
+        state = state * 1103515245 + 12345;
+        return (state >> 16) % range;
+}
+
+static std::string randomSequence(int size) {
+        static char const bases[] = "ACGT";
+        std::string sequence(size, 'A');
+        for (int i = 0; i < size; ++i) {
+                sequence[i] = bases[nextRandom(4)];
+        }
+        return sequence;
+}
+
+//cut the genome in a chain of nodes that overlap by k - 1 bases
+static void cutGenome(std::string const &genome, int k,
+        std::vector<std::string> &nodes)
+{
+        int start = 0;
+        while (start + k < genome.size()) {
+                int end = std::min<int>(start + 200 + nextRandom(400),
+                        genome.size());
+                nodes.push_back(genome.substr(start, end - start));
+                start = end - (k - 1);
+        }
+}
+
+//neighbours of node i of the chain, numbered from 1
+static void chainEdges(int i, int num_nodes, std::vector<int> &in_edges,
+        std::vector<int> &out_edges)
+{
+        in_edges.clear();
+        out_edges.clear();
+        if (i > 1) {
+                in_edges.push_back(i - 1);
+        }
+        if (i < num_nodes) {
+                out_edges.push_back(i + 1);
+        }
+}
+
+//the settings expect the graph as a file in the format of the assembler
+static void writeGraph(std::vector<std::string> const &nodes,
+        std::string const &filename)
+{
+        std::ofstream file(filename.c_str());
+        std::vector<int> in_edges;
+        std::vector<int> out_edges;
+        for (int i = 1; i <= nodes.size(); ++i) {
+                chainEdges(i, nodes.size(), in_edges, out_edges);
+                file << ">NODE " << i << " " << nodes[i - 1].size() << " "
+                        << in_edges.size();
+                for (int node : in_edges) {
+                        file << " " << node;
+                }
+                file << " " << out_edges.size();
+                for (int node : out_edges) {
+                        file << " " << node;
+                }
+                file << "\n" << nodes[i - 1] << "\n";
+        }
+}
+
+static void buildGraph(std::vector<std::string> const &nodes, int k,
+        Graph &graph)
+{
+        graph.set_k(k);
+        std::vector<int> in_edges;
+        std::vector<int> out_edges;
+        for (int i = 1; i <= nodes.size(); ++i) {
+                chainEdges(i, nodes.size(), in_edges, out_edges);
+                graph.addNode(nodes[i - 1], in_edges, out_edges);
+        }
+        graph.init_seed_finder("allocbench");
+}
+
+//reads of the genome with one substitution per 30 bases on average
+static void sampleReads(std::string const &genome, int count, int size,
+        std::vector<ReadRecord> &records)
+{
+        static char const bases[] = "ACGT";
+        records.resize(count);
+        for (int i = 0; i < count; ++i) {
+                int start = nextRandom(genome.size() - size);
+                records[i].preRead = "@read" + std::to_string(i);
+                records[i].read = genome.substr(start, size);
+                for (char &base : records[i].read) {
+                        if (nextRandom(30) == 0) {
+                                base = bases[nextRandom(4)];
+                        }
+                }
+        }
+}
+
+//allocations per read when correcting a chunk of reads of the given size,
+//after a first chunk has grown the buffers of the worker
+static double allocationsPerRead(ReadCorrection &correction,
+        std::string const &genome, int size)
+{
+        int const count = 200;
+        std::vector<ReadRecord> warmup;
+        sampleReads(genome, count, size, warmup);
+        correction.correctChunk(warmup);
+        std::vector<ReadRecord> records;
+        sampleReads(genome, count, size, records);
+        allocations = 0;
+        counting = true;
+        correction.correctChunk(records);
+        counting = false;
+        int corrected = 0;
+        for (ReadRecord const &record : records) {
+                if (!record.correction.empty()) {
+                        ++corrected;
+                }
+        }
+        double per_read = double(allocations) / count;
+        std::cout << "reads of " << size << " bp: " << corrected << " of "
+                << count << " corrected, " << per_read
+                << " allocations per read" << std::endl;
+        return per_read;
+}
+
+int main() {
+        int const k = 31;
+        std::string genome = randomSequence(50000);
+        std::vector<std::string> nodes;
+        cutGenome(genome, k, nodes);
+        writeGraph(nodes, "allocbench_graph.fasta");
+        char const *args[] = {"allocbench", "-t", "1", "-k", "31",
+                "-g", "allocbench_graph.fasta", "-o", "allocbench_output",
+                "-m", "long"};
+        Settings settings(sizeof(args) / sizeof(args[0]),
+                const_cast<char **>(args));
+        Graph graph(settings);
+        buildGraph(nodes, k, graph);
+        ReadCorrection correction(graph, settings);
+        //the buffers of the worker and the path arena keep their storage,
+        //what is left is about the output, independent of the read size
+        double const max_per_read = 16;
+        double short_reads = allocationsPerRead(correction, genome, 500);
+        double long_reads = allocationsPerRead(correction, genome, 5000);
+        if (short_reads > max_per_read || long_reads > max_per_read) {
+                std::cerr << "more than " << max_per_read
+                        << " allocations per read" << std::endl;
+                return 1;
+        }
+        return 0;
+}
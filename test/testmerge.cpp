@@ -0,0 +1,81 @@
+/*******************************************************************************
+ *   Copyright (C) 2014, 2015 Giles Miclotte (giles.miclotte@intec.ugent.be)   *
+ *   This file is part of Jabba                                                *
+ *                                                                             *
+ *   This program is free software; you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published by      *
+ *   the Free Software Foundation; either version 2 of the License, or         *
+ *   (at your option) any later version.                                       *
+ *                                                                             *
+ *   This program is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *   GNU General Public License for more details.                              *
+ *                                                                             *
+ *   You should have received a copy of the GNU General Public License         *
+ *   along with this program; if not, write to the                             *
+ *   Free Software Foundation, Inc.,                                           *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.                 *
+ *******************************************************************************/
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "AlignedRead.hpp"
+#include "CorrectionContext.hpp"
+#include "Read.hpp"
+
+//alignment of the read on a single node
+static LocalAlignment makeAlignment(int read_start, int read_end, int node,
+        PathArena &paths)
+{
+        LocalAlignment la;
+        la.set_read_start(read_start);
+        la.set_read_end(read_end);
+        la.set_ref_start(0);
+        la.set_ref_end(read_end - read_start);
+        la.set_path(paths, std::vector<int>(1, node));
+        return la;
+}
+
+//a split read finds an alignment crossing a window boundary twice: in full
+//from the window it starts in and truncated at the end of the other window,
+//the merged alignment has to keep its full length whatever the order
+static bool testBoundaryCrossing(bool truncated_first) {
+        std::string meta = "read";
+        std::string sequence(4000, 'A');
+        Read read(0, meta, sequence);
+        CorrectionContext context;
+        AlignedRead ar(read, LONG, context);
+        LocalAlignment full = makeAlignment(1000, 3900, 7, context.paths);
+        LocalAlignment truncated = makeAlignment(1000, 3000, 7, context.paths);
+        if (truncated_first) {
+                ar.correct(truncated);
+                ar.correct(full);
+        } else {
+                ar.correct(full);
+                ar.correct(truncated);
+        }
+        ar.merge();
+        std::vector<LocalAlignment> const &als = ar.get_local_alignments();
+        if (als.size() != 1) {
+                std::cerr << "expected 1 alignment, got " << als.size()
+                        << std::endl;
+                return false;
+        }
+        LocalAlignment const &la = als[0];
+        if (la.get_read_start() != 1000 || la.get_read_end() != 3900
+                || la.get_ref_end() - la.get_ref_start() != 2900)
+        {
+                std::cerr << "boundary-crossing alignment shrunk to "
+                        << la.to_string(read.get_id()) << std::endl;
+                return false;
+        }
+        return true;
+}
+
+int main(int argc, char **argv) {
+        bool ok = testBoundaryCrossing(false);
+        ok = testBoundaryCrossing(true) && ok;
+        return ok ? 0 : 1;
+}